@@ -6,19 +6,32 @@
   @date 2021
 */
 
-#include <errno.h>
 #include <ctype.h>
-#include <stdio.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "calc_error.h"
 #include "calc_command.h"
+#include "../poly/poly_eval.h"
+#include "../poly/poly_terms.h"
 #include "../poly/io/poly_io.h"
 #include "../poly/io/numeric_parser.h"
+#include "../poly/io/output_writer.h"
+#include "../poly/io/poly_file.h"
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
+/**
+ * Prints a number in a separate line of the standard output.
+ * @param[in] value : number
+ */
+static void PrintNumberLine(long value) {
+    OutputWriter* output = StandardOutput();
+    WriteLong(output, value);
+    WriteLineEnd(output);
+}
+
 static void ProcessZeroCommand(PolyStack* stack) {
     PushPoly(stack, PolyZero());
 }
@@ -30,7 +43,7 @@ static void ProcessIsCoeffCommand(PolyStack* stack, int lineNumber) {
     }
 
     Poly top = TopPoly(stack);
-    printf("%d\n", PolyIsCoeff(&top));
+    PrintNumberLine(PolyIsCoeff(&top));
 }
 
 static void ProcessIsZeroCommand(PolyStack* stack, int lineNumber) {
@@ -40,7 +53,7 @@ static void ProcessIsZeroCommand(PolyStack* stack, int lineNumber) {
     }
 
     Poly top = TopPoly(stack);
-    printf("%d\n", PolyIsZero(&top));
+    PrintNumberLine(PolyIsZero(&top));
 }
 
 static void ProcessCloneCommand(PolyStack* stack, int lineNumber) {
@@ -49,22 +62,49 @@ static void ProcessCloneCommand(PolyStack* stack, int lineNumber) {
         return;
     }
 
+    if (stack->lazy) {
+        StackShareTop(stack);
+        return;
+    }
+
     Poly top = TopPoly(stack);
     PushPoly(stack, PolyClone(&top));
 }
 
+/**
+ * Returns the number of monomials of a poly.
+ * @param[in] p : poly
+ * @return number of monomials, zero for a constant poly
+ */
+static size_t PolyLength(const Poly* p) {
+    return (PolyIsCoeff(p) ? 0 : p->size);
+}
+
 static void ProcessAddCommand(PolyStack* stack, int lineNumber) {
     if (stack->size < 2) {
         PrintError(STACK_UNDERFLOW, lineNumber);
         return;
     }
 
+    if (stack->lazy) {
+        PolyExpr* firstTop = PopExpr(stack);
+        PushExpr(stack, ExprAdd(firstTop, PopExpr(stack)));
+        return;
+    }
+
     Poly firstTop = PopPoly(stack);
     Poly secondTop = PopPoly(stack);
-    PushPoly(stack, PolyAdd(&firstTop, &secondTop));
 
-    PolyDestroy(&firstTop);
-    PolyDestroy(&secondTop);
+    /* The smaller poly is merged into the larger one, which keeps its monomials */
+    if (PolyLength(&firstTop) < PolyLength(&secondTop)) {
+        PolyAddScaledInPlace(&secondTop, 1, &firstTop);
+        PushPoly(stack, secondTop);
+        PolyDestroy(&firstTop);
+    } else {
+        PolyAddScaledInPlace(&firstTop, 1, &secondTop);
+        PushPoly(stack, firstTop);
+        PolyDestroy(&secondTop);
+    }
 }
 
 static void ProcessMulCommand(PolyStack* stack, int lineNumber) {
@@ -73,9 +113,15 @@ static void ProcessMulCommand(PolyStack* stack, int lineNumber) {
         return;
     }
 
+    if (stack->lazy) {
+        PolyExpr* firstTop = PopExpr(stack);
+        PushExpr(stack, ExprMul(firstTop, PopExpr(stack)));
+        return;
+    }
+
     Poly firstTop = PopPoly(stack);
     Poly secondTop = PopPoly(stack);
-    PushPoly(stack, PolyMul(&firstTop, &secondTop));
+    PushPoly(stack, PolyMulReordered(&firstTop, &secondTop));
 
     PolyDestroy(&firstTop);
     PolyDestroy(&secondTop);
@@ -87,9 +133,14 @@ static void ProcessNegCommand(PolyStack* stack, int lineNumber) {
         return;
     }
 
+    if (stack->lazy) {
+        PushExpr(stack, ExprNeg(PopExpr(stack)));
+        return;
+    }
+
     Poly top = PopPoly(stack);
-    PushPoly(stack, PolyNeg(&top));
-    PolyDestroy(&top);
+    PolyNegInPlace(&top);
+    PushPoly(stack, top);
 }
 
 static void ProcessSubCommand(PolyStack* stack, int lineNumber) {
@@ -98,12 +149,25 @@ static void ProcessSubCommand(PolyStack* stack, int lineNumber) {
         return;
     }
 
+    if (stack->lazy) {
+        PolyExpr* firstTop = PopExpr(stack);
+        PushExpr(stack, ExprSub(firstTop, PopExpr(stack)));
+        return;
+    }
+
     Poly firstTop = PopPoly(stack);
     Poly secondTop = PopPoly(stack);
-    PushPoly(stack, PolySub(&firstTop, &secondTop));
 
-    PolyDestroy(&firstTop);
-    PolyDestroy(&secondTop);
+    if (PolyLength(&firstTop) < PolyLength(&secondTop)) {
+        PolyNegInPlace(&secondTop);
+        PolyAddScaledInPlace(&secondTop, 1, &firstTop);
+        PushPoly(stack, secondTop);
+        PolyDestroy(&firstTop);
+    } else {
+        PolyAddScaledInPlace(&firstTop, -1, &secondTop);
+        PushPoly(stack, firstTop);
+        PolyDestroy(&secondTop);
+    }
 }
 
 static void ProcessIsEqCommand(PolyStack* stack, int lineNumber) {
@@ -112,12 +176,8 @@ static void ProcessIsEqCommand(PolyStack* stack, int lineNumber) {
         return;
     }
 
-    Poly firstTop = PopPoly(stack);
-    Poly secondTop = PopPoly(stack);
-    printf("%d\n", PolyIsEq(&firstTop, &secondTop));
-
-    PushPoly(stack, secondTop);
-    PushPoly(stack, firstTop);
+    StackForce(stack, 2);
+    PrintNumberLine(PolyIsEq(&stack->content[stack->size - 1], &stack->content[stack->size - 2]));
 }
 
 static void ProcessDegCommand(PolyStack* stack, int lineNumber) {
@@ -127,16 +187,18 @@ static void ProcessDegCommand(PolyStack* stack, int lineNumber) {
     }
 
     Poly top = TopPoly(stack);
-    printf("%d\n", PolyDeg(&top));
+    PrintNumberLine(PolyDeg(&top));
 }
 
-static bool CommandValidArgument(const char* source, size_t from) {
-    size_t to = strlen(source);
-
-    bool illegalCornerValues = source[from - 1] != ' ' || to - from == 0
-            || (to - from == 1 && source[from] == '-');
-
-    if (errno || illegalCornerValues)
+/**
+ * Checks whether a range [@p from, @p to) of characters from @p source is a number.
+ * @param[in] source : command
+ * @param[in] from : including start
+ * @param[in] to : excluding end
+ * @return Is range a number?
+ */
+static bool CommandValidArgumentRange(const char* source, size_t from, size_t to) {
+    if (to == from || (to - from == 1 && source[from] == '-'))
         return false;
 
     for (size_t i = from; i < to; i++) {
@@ -148,6 +210,143 @@ static bool CommandValidArgument(const char* source, size_t from) {
     return true;
 }
 
+/**
+ * Gives index of an end of the space-separated argument starting from @p from.
+ * @param[in] source : command
+ * @param[in] from : starting position of an argument
+ * @return index of a space or a terminating null character
+ */
+static size_t CommandArgumentEnd(const char* source, size_t from) {
+    while (source[from] != '\0' && source[from] != ' ')
+        from++;
+    return from;
+}
+
+/**
+ * Counts space-separated numeric arguments of a command starting from index @p from,
+ * which is either zero or follows a space.
+ * @param[in] source : command
+ * @param[in] from : index of the first argument
+ * @return number of arguments or zero if any of them is invalid
+ */
+static size_t CommandArgumentCount(const char* source, size_t from) {
+    const size_t length = strlen(source);
+    size_t count = 0;
+
+    if (from > length || (from > 0 && source[from - 1] != ' '))
+        return 0;
+
+    for (size_t to; from <= length; from = to + 1) {
+        to = CommandArgumentEnd(source, from);
+        if (!CommandValidArgumentRange(source, from, to))
+            return 0;
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Parses space-separated parameters of a command starting from index @p from.
+ * @param[in] source : command
+ * @param[in] from : index of the first parameter
+ * @param[in] count : destination for the number of parameters
+ * @return array of parameters or NULL if any of them is invalid
+ */
+static size_t* CommandParameterList(const char* source, size_t from, size_t* count) {
+    *count = CommandArgumentCount(source, from);
+    if (*count == 0)
+        return NULL;
+
+    size_t* params = malloc(*count * sizeof(size_t));
+    CHECK_NULL_PTR(params);
+
+    NumberStatus status = NUMBER_OK;
+
+    for (size_t i = 0, to; i < *count; i++, from = to + 1) {
+        to = CommandArgumentEnd(source, from);
+        params[i] = SubstringToParameter(source, from, to, &status);
+    }
+
+    if (status != NUMBER_OK) {
+        free(params);
+        return NULL;
+    }
+
+    return params;
+}
+
+/**
+ * Parses space-separated coefficients of a command starting from index @p from.
+ * @param[in] source : command
+ * @param[in] from : index of the first coefficient
+ * @param[in] count : destination for the number of coefficients
+ * @return array of coefficients or NULL if any of them is invalid
+ */
+static poly_coeff_t* CommandCoeffList(const char* source, size_t from, size_t* count) {
+    *count = CommandArgumentCount(source, from);
+    if (*count == 0)
+        return NULL;
+
+    poly_coeff_t* coeffs = malloc(*count * sizeof(poly_coeff_t));
+    CHECK_NULL_PTR(coeffs);
+
+    NumberStatus status = NUMBER_OK;
+
+    for (size_t i = 0, to; i < *count; i++, from = to + 1) {
+        to = CommandArgumentEnd(source, from);
+        coeffs[i] = SubstringToCoeff(source, from, to, &status);
+    }
+
+    if (status != NUMBER_OK) {
+        free(coeffs);
+        return NULL;
+    }
+
+    return coeffs;
+}
+
+/**
+ * Parses space-separated real numbers of a command starting from index @p from.
+ * @param[in] source : command
+ * @param[in] from : index of the first number, following a space
+ * @param[in] count : destination for the number of numbers
+ * @return array of numbers or NULL if any of them is invalid
+ */
+static double* CommandDoubleList(const char* source, size_t from, size_t* count) {
+    const size_t length = strlen(source);
+
+    *count = 0;
+    if (from > length || source[from - 1] != ' ')
+        return NULL;
+
+    for (size_t i = from; i <= length; i = CommandArgumentEnd(source, i) + 1)
+        (*count)++;
+
+    double* numbers = malloc(*count * sizeof(double));
+    CHECK_NULL_PTR(numbers);
+
+    NumberStatus status = NUMBER_OK;
+
+    for (size_t i = 0, to; i < *count; i++, from = to + 1) {
+        to = CommandArgumentEnd(source, from);
+        numbers[i] = SubstringToDouble(source, from, to, &status);
+    }
+
+    if (status != NUMBER_OK) {
+        free(numbers);
+        return NULL;
+    }
+
+    return numbers;
+}
+
+static bool CommandValidArgument(const char* source, size_t from, NumberStatus status) {
+    if (status != NUMBER_OK || source[from - 1] != ' ')
+        return false;
+    return CommandValidArgumentRange(source, from, strlen(source));
+}
+
 static bool CommandValidDelimeter(const char* command, size_t nameLength) {
     return nameLength == strlen(command) || isblank(command[nameLength]);
 }
@@ -155,12 +354,13 @@ static bool CommandValidDelimeter(const char* command, size_t nameLength) {
 static void ProcessDegByCommand(PolyStack* stack, char* command, int lineNumber) {
     const size_t nameLength = 6; // strlen("DEG_BY");
     const size_t commandLength = strlen(command);
-    size_t degByIdx = SubstringToParameter(command, nameLength + 1, commandLength);
+    NumberStatus status = NUMBER_OK;
+    size_t degByIdx = SubstringToParameter(command, nameLength + 1, commandLength, &status);
 
     if (!CommandValidDelimeter(command, nameLength)) {
         PrintError(WRONG_COMMAND, lineNumber);
         return;
-    } else if (!CommandValidArgument(command, nameLength + 1)) {
+    } else if (!CommandValidArgument(command, nameLength + 1, status)) {
         PrintError(WRONG_DEG_VARIABLE, lineNumber);
         return;
     } else if (stack->size < 1) {
@@ -170,18 +370,69 @@ static void ProcessDegByCommand(PolyStack* stack, char* command, int lineNumber)
 
     Poly top = TopPoly(stack);
     poly_exp_t topDegBy = PolyDegBy(&top, degByIdx);
-    printf("%d\n", topDegBy);
+    PrintNumberLine(topDegBy);
+}
+
+/**
+ * Checks whether @p perm is a permutation of {0, ..., @p n - 1}.
+ * @param[in] perm : array of indexes
+ * @param[in] n : length of @p perm
+ * @return Is @p perm a permutation?
+ */
+static bool IsPermutation(const size_t perm[], size_t n) {
+    bool* seen = calloc(n, sizeof(bool));
+    CHECK_NULL_PTR(seen);
+
+    bool isPermutation = true;
+    for (size_t i = 0; i < n && isPermutation; i++) {
+        isPermutation = perm[i] < n && !seen[perm[i]];
+        if (isPermutation)
+            seen[perm[i]] = true;
+    }
+
+    free(seen);
+
+    return isPermutation;
+}
+
+static void ProcessPermuteCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 7; // strlen("PERMUTE");
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    }
+
+    size_t permLength = 0;
+    size_t* perm = CommandParameterList(command, nameLength + 1, &permLength);
+
+    if (!perm || !IsPermutation(perm, permLength)) {
+        PrintError(WRONG_PERMUTE_PARAMETER, lineNumber);
+        free(perm);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        free(perm);
+        return;
+    }
+
+    Poly top = PopPoly(stack);
+    PushPoly(stack, PolyPermuteVars(&top, permLength, perm));
+
+    PolyDestroy(&top);
+    free(perm);
 }
 
 static void ProcessAtCommand(PolyStack* stack, char* command, int lineNumber) {
     const size_t nameLength = 2; // strlen("AT");
     const size_t commandLength = strlen(command);
-    poly_coeff_t valueForAt = SubstringToCoeff(command, nameLength + 1, commandLength);
+    NumberStatus status = NUMBER_OK;
+    poly_coeff_t valueForAt = SubstringToCoeff(command, nameLength + 1, commandLength, &status);
 
     if (!CommandValidDelimeter(command, nameLength)) {
         PrintError(WRONG_COMMAND, lineNumber);
         return;
-    } else if (!CommandValidArgument(command, nameLength + 1)) {
+    } else if (!CommandValidArgument(command, nameLength + 1, status)) {
         PrintError(WRONG_AT_VALUE, lineNumber);
         return;
     } else if (stack->size < 1) {
@@ -196,6 +447,466 @@ static void ProcessAtCommand(PolyStack* stack, char* command, int lineNumber) {
     PolyDestroy(&top);
 }
 
+static void ProcessScaleCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 5; // strlen("SCALE");
+    const size_t commandLength = strlen(command);
+    NumberStatus status = NUMBER_OK;
+    poly_coeff_t scale = SubstringToCoeff(command, nameLength + 1, commandLength, &status);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (!CommandValidArgument(command, nameLength + 1, status)) {
+        PrintError(WRONG_SCALE_VALUE, lineNumber);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return;
+    }
+
+    if (stack->lazy) {
+        PushExpr(stack, ExprScale(PopExpr(stack), scale));
+        return;
+    }
+
+    Poly top = PopPoly(stack);
+    PolyScaleInPlace(&top, scale);
+    PushPoly(stack, top);
+}
+
+static void ProcessEvalCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 4; // strlen("EVAL");
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    }
+
+    size_t pointLength = 0;
+    poly_coeff_t* point = CommandCoeffList(command, nameLength + 1, &pointLength);
+
+    if (!point) {
+        PrintError(WRONG_EVAL_VALUE, lineNumber);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        free(point);
+        return;
+    }
+
+    PrintNumberLine(ProgramEvalPoint(TopProgram(stack), pointLength, point));
+
+    free(point);
+}
+
+static void ProcessEvalDoubleCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 5; // strlen("EVALF");
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    }
+
+    size_t pointLength = 0;
+    double* point = CommandDoubleList(command, nameLength + 1, &pointLength);
+
+    if (!point) {
+        PrintError(WRONG_EVALF_VALUE, lineNumber);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        free(point);
+        return;
+    }
+
+    Poly top = TopPoly(stack);
+    WriteDouble(StandardOutput(), PolyEvalDouble(&top, pointLength, point, true));
+    WriteLineEnd(StandardOutput());
+
+    free(point);
+}
+
+/** Maximal number of coordinates of points read and evaluated at once by EVAL_MANY. */
+#define EVAL_MANY_CHUNK_COORDS (1 << 20)
+
+/** Points read by EVAL_MANY and waiting for evaluation. */
+typedef struct PointChunk {
+    size_t        count;         ///< number of points
+    size_t        n;             ///< number of coordinates of each point
+    size_t        coordCapacity; ///< number of coordinates @p coords has room for
+    size_t        capacity;      ///< number of values @p values has room for
+    poly_coeff_t* coords;        ///< coordinates of points, one point after another
+    poly_coeff_t* values;        ///< values at points
+} PointChunk;
+
+/**
+ * Returns the number of coordinates of points of a chunk after appending
+ * a point of @p n coordinates, as shorter points are padded with zeros.
+ * @param[in] chunk : chunk of points
+ * @param[in] n : number of coordinates of the appended point
+ * @return number of coordinates
+ */
+static size_t PointChunkSizeWith(const PointChunk* chunk, size_t n) {
+    size_t width = (n > chunk->n ? n : chunk->n);
+    return (chunk->count + 1) * (width > 0 ? width : 1);
+}
+
+/**
+ * Appends a point to a chunk, padding shorter points with zeros.
+ * Buffers grow with the number of points, so a chunk takes only as much memory as its points.
+ * @param[in] chunk : chunk of points
+ * @param[in] point : coordinates of the point
+ * @param[in] n : number of coordinates
+ */
+static void PointChunkAppend(PointChunk* chunk, const poly_coeff_t point[], size_t n) {
+    size_t width = (n > chunk->n ? n : chunk->n);
+    size_t coordCount = (chunk->count + 1) * width;
+
+    if (coordCount > chunk->coordCapacity) {
+        chunk->coordCapacity = (2 * chunk->coordCapacity > coordCount ? 2 * chunk->coordCapacity : coordCount);
+        chunk->coords = realloc(chunk->coords, chunk->coordCapacity * sizeof(poly_coeff_t));
+        CHECK_NULL_PTR(chunk->coords);
+    }
+
+    if (chunk->count == chunk->capacity) {
+        chunk->capacity = 2 * chunk->capacity + 1;
+        chunk->values = realloc(chunk->values, chunk->capacity * sizeof(poly_coeff_t));
+        CHECK_NULL_PTR(chunk->values);
+    }
+
+    /* Widened points move from the last one, so none is overwritten before it moves */
+    if (width > chunk->n) {
+        for (size_t pointID = chunk->count; pointID-- > 0;) {
+            poly_coeff_t* widened = &chunk->coords[pointID * width];
+            memmove(widened, &chunk->coords[pointID * chunk->n], chunk->n * sizeof(poly_coeff_t));
+            memset(widened + chunk->n, 0, (width - chunk->n) * sizeof(poly_coeff_t));
+        }
+
+        chunk->n = width;
+    }
+
+    poly_coeff_t* dest = &chunk->coords[chunk->count++ * chunk->n];
+    memcpy(dest, point, n * sizeof(poly_coeff_t));
+    memset(dest + n, 0, (chunk->n - n) * sizeof(poly_coeff_t));
+}
+
+/**
+ * Evaluates @p p at all points of a chunk, prints the values and empties the chunk.
+ * The values are written out at once, so they are not held back until the last chunk.
+ * @param[in] chunk : chunk of points
+ * @param[in] p : poly
+ */
+static void PointChunkFlush(PointChunk* chunk, const Poly* p) {
+    PolyEvalPoints(p, chunk->n, chunk->count, chunk->coords, chunk->values);
+
+    for (size_t pointID = 0; pointID < chunk->count; pointID++)
+        PrintNumberLine(chunk->values[pointID]);
+
+    WriterFlush(StandardOutput());
+    chunk->count = 0;
+    chunk->n = 0;
+}
+
+/**
+ * Skips points from the calculator input up to an empty line.
+ * @param[in] input : calculator input
+ * @return number of consumed lines of the calculator input
+ */
+static int SkipPoints(LineReader* input) {
+    int consumedLines = 0;
+    char* line;
+    size_t length;
+
+    while (LineReaderNext(input, &line, &length)) {
+        consumedLines++;
+        if (length == 0)
+            break;
+    }
+
+    return consumedLines;
+}
+
+/**
+ * Evaluates the top polynomial at points read from @p input, one point per line.
+ * Points from the calculator input end with an empty line.
+ * @param[in] stack : non-empty stack with polynomials
+ * @param[in] input : source of points
+ * @param[in] fromCalcInput : is @p input the calculator input?
+ * @param[in] lineNumber : ordinal of the command line
+ * @return number of consumed lines of the calculator input
+ */
+static int EvalManyFrom(PolyStack* stack, LineReader* input, bool fromCalcInput, int lineNumber) {
+    int consumedLines = 0;
+    char* line;
+    size_t length;
+
+    Poly top = TopPoly(stack);
+    PointChunk chunk = {.count = 0, .n = 0, .coordCapacity = 0, .capacity = 0, .coords = NULL, .values = NULL};
+
+    while (LineReaderNext(input, &line, &length)) {
+        if (fromCalcInput)
+            consumedLines++;
+        if (fromCalcInput && length == 0)
+            break;
+
+        int pointLineNumber = (fromCalcInput ? lineNumber + consumedLines : lineNumber);
+        bool validLine = (length > 0 && !memchr(line, '\0', length));
+        size_t n = 0;
+
+        poly_coeff_t* point = (validLine ? CommandCoeffList(line, 0, &n) : NULL);
+
+        if (!point) {
+            PrintError(WRONG_EVAL_VALUE, pointLineNumber);
+        } else {
+            /* A single point is evaluated alone even if it has more coordinates than a chunk */
+            if (chunk.count > 0 && PointChunkSizeWith(&chunk, n) > EVAL_MANY_CHUNK_COORDS)
+                PointChunkFlush(&chunk, &top);
+
+            PointChunkAppend(&chunk, point, n);
+        }
+
+        free(point);
+    }
+
+    if (chunk.count > 0)
+        PointChunkFlush(&chunk, &top);
+
+    free(chunk.coords);
+    free(chunk.values);
+
+    return consumedLines;
+}
+
+/**
+ * Returns a path given to a command, separated from its name by a space.
+ * @param[in] command : command
+ * @param[in] nameLength : length of the name of the command
+ * @return path or NULL if there is none
+ */
+static const char* CommandPath(const char* command, size_t nameLength) {
+    bool hasPath = (command[nameLength] == ' ' && command[nameLength + 1] != '\0');
+    return (hasPath ? &command[nameLength + 1] : NULL);
+}
+
+static int ProcessEvalManyCommand(PolyStack* stack, LineReader* input, char* command, int lineNumber) {
+    const size_t nameLength = 9; // strlen("EVAL_MANY");
+    const size_t commandLength = strlen(command);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return 0;
+    } else if (commandLength == nameLength) {
+        if (stack->size >= 1)
+            return EvalManyFrom(stack, input, true, lineNumber);
+
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return SkipPoints(input);
+    }
+
+    LineReader points;
+    const char* path = CommandPath(command, nameLength);
+    bool opened = (path && LineReaderOpen(&points, path));
+
+    if (!opened) {
+        PrintError(WRONG_FILE, lineNumber);
+        return 0;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+    } else {
+        EvalManyFrom(stack, &points, false, lineNumber);
+    }
+
+    LineReaderClose(&points);
+
+    return 0;
+}
+
+/**
+ * Checks that a flat record has a coefficient and exponents fitting poly_exp_t.
+ * @param[in] record : coefficient followed by exponents
+ * @param[in] n : length of the record
+ * @return Is the record correct?
+ */
+static bool FlatRecordValid(const poly_coeff_t record[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        if (record[i] < 0 || record[i] > INT_MAX)
+            return false;
+    }
+
+    return (n > 0);
+}
+
+/**
+ * Builds a polynomial of flat records read from @p input, one term "c e0 e1 ..."
+ * per line, and pushes it onto the stack. Records from the calculator input
+ * end with an empty line. The terms are collected and sorted once, so the
+ * polynomial is built bottom-up instead of by repeated additions. Nothing is
+ * pushed if any record is wrong.
+ * @param[in] stack : stack with polynomials
+ * @param[in] input : source of records
+ * @param[in] fromCalcInput : is @p input the calculator input?
+ * @param[in] lineNumber : ordinal of the command line
+ * @return number of consumed lines of the calculator input
+ */
+static int FlatFrom(PolyStack* stack, LineReader* input, bool fromCalcInput, int lineNumber) {
+    int consumedLines = 0;
+    bool correct = true;
+    char* line;
+    size_t length;
+
+    PolyTerms terms;
+    TermsInitialize(&terms, 0);
+    poly_exp_t* exps = NULL;
+
+    while (LineReaderNext(input, &line, &length)) {
+        if (fromCalcInput)
+            consumedLines++;
+        if (fromCalcInput && length == 0)
+            break;
+
+        int recordLineNumber = (fromCalcInput ? lineNumber + consumedLines : lineNumber);
+        bool validLine = (length > 0 && !memchr(line, '\0', length));
+        size_t n = 0;
+
+        poly_coeff_t* record = (validLine ? CommandCoeffList(line, 0, &n) : NULL);
+
+        if (!record || !FlatRecordValid(record, n)) {
+            PrintError(WRONG_FLAT_VALUE, recordLineNumber);
+            correct = false;
+        } else if (correct) {
+            /* Records shorter than others have zero exponents of the remaining variables */
+            if (n - 1 > terms.vars) {
+                TermsWiden(&terms, n - 1);
+                exps = realloc(exps, terms.vars * sizeof(poly_exp_t));
+                CHECK_NULL_PTR(exps);
+            }
+
+            for (size_t var = 0; var < terms.vars; var++)
+                exps[var] = (var + 1 < n ? (poly_exp_t) record[var + 1] : 0);
+
+            TermsAppend(&terms, record[0], exps);
+        }
+
+        free(record);
+    }
+
+    if (correct)
+        PushPoly(stack, PolyFromTerms(&terms));
+
+    TermsDestroy(&terms);
+    free(exps);
+
+    return consumedLines;
+}
+
+static int ProcessFlatCommand(PolyStack* stack, LineReader* input, char* command, int lineNumber) {
+    const size_t nameLength = 4; // strlen("FLAT");
+    const size_t commandLength = strlen(command);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return 0;
+    } else if (commandLength == nameLength) {
+        return FlatFrom(stack, input, true, lineNumber);
+    }
+
+    LineReader records;
+    const char* path = CommandPath(command, nameLength);
+    bool opened = (path && LineReaderOpen(&records, path));
+
+    if (!opened) {
+        PrintError(WRONG_FILE, lineNumber);
+        return 0;
+    }
+
+    FlatFrom(stack, &records, false, lineNumber);
+    LineReaderClose(&records);
+
+    return 0;
+}
+
+static void ProcessPrintFlatCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 10; // strlen("PRINT_FLAT");
+    const size_t commandLength = strlen(command);
+    const char* path = CommandPath(command, nameLength);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return;
+    }
+
+    Poly top = TopPoly(stack);
+
+    /* Records on the standard output end with an empty line, so they can be read by FLAT */
+    if (commandLength == nameLength) {
+        OutputWriter* output = StandardOutput();
+        PolyPrintFlat(&top, output);
+        WriteLineEnd(output);
+        return;
+    }
+
+    OutputWriter records;
+
+    if (!path || !WriterOpen(&records, path)) {
+        PrintError(WRONG_FILE, lineNumber);
+        return;
+    }
+
+    PolyPrintFlat(&top, &records);
+
+    if (!WriterClose(&records))
+        PrintError(WRONG_FILE, lineNumber);
+}
+
+static void ProcessSaveCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 4; // strlen("SAVE");
+    const char* path = CommandPath(command, nameLength);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (stack->size < 1) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return;
+    }
+
+    Poly top = TopPoly(stack);
+
+    if (!path || !PolySave(&top, path))
+        PrintError(WRONG_FILE, lineNumber);
+}
+
+static void ProcessLoadCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 4; // strlen("LOAD");
+    const char* path = CommandPath(command, nameLength);
+    Poly loaded;
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (!path || !PolyLoad(path, &loaded)) {
+        PrintError(WRONG_FILE, lineNumber);
+        return;
+    }
+
+    PushPoly(stack, loaded);
+}
+
+static void ProcessCheckpointCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 10; // strlen("CHECKPOINT");
+    const char* path = CommandPath(command, nameLength);
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (!path || !StackCheckpoint(stack, path)) {
+        PrintError(WRONG_FILE, lineNumber);
+    }
+}
+
 static void ProcessPrintCommand(PolyStack* stack, int lineNumber) {
     if (stack->size < 1) {
         PrintError(STACK_UNDERFLOW, lineNumber);
@@ -204,7 +915,7 @@ static void ProcessPrintCommand(PolyStack* stack, int lineNumber) {
 
     Poly top = TopPoly(stack);
     PolyPrint(&top);
-    printf("\n");
+    WriteLineEnd(StandardOutput());
 }
 
 static void ProcessPopCommand(PolyStack* stack, int lineNumber) {
@@ -220,12 +931,13 @@ static void ProcessPopCommand(PolyStack* stack, int lineNumber) {
 static void ProcessComposeCommand(PolyStack* stack, char* command, int lineNumber) {
     const size_t nameLength = 7; // strlen("COMPOSE");
     const size_t commandLength = strlen(command);
-    size_t composeDepth = SubstringToParameter(command, nameLength + 1, commandLength);
+    NumberStatus status = NUMBER_OK;
+    size_t composeDepth = SubstringToParameter(command, nameLength + 1, commandLength, &status);
 
     if (!CommandValidDelimeter(command, nameLength)) {
         PrintError(WRONG_COMMAND, lineNumber);
         return;
-    } else if (!CommandValidArgument(command, nameLength + 1)) {
+    } else if (!CommandValidArgument(command, nameLength + 1, status)) {
         PrintError(WRONG_COMPOSE_PARAMETER, lineNumber);
         return;
     } else if (stack->size == 0 || stack->size - 1 < composeDepth) {
@@ -233,25 +945,126 @@ static void ProcessComposeCommand(PolyStack* stack, char* command, int lineNumbe
         return;
     }
 
-    Poly topPoly = PopPoly(stack), toCompose[composeDepth];
+    Poly topPoly = PopPoly(stack);
+
+    /* Inner polynomials beyond the variables of the outer one are not accessed, so they stay lazy */
+    size_t usedDepth = PolyVarCount(&topPoly);
+    if (usedDepth > composeDepth)
+        usedDepth = composeDepth;
+    StackForceRange(stack, stack->size - composeDepth, usedDepth);
 
-    for (size_t i = 0; i < composeDepth; i++)
-        toCompose[composeDepth - i - 1] = PopPoly(stack);
-    PushPoly(stack, PolyCompose(&topPoly, composeDepth, toCompose));
+    /* Inner polynomials are read in place from the stack, the deepest one first */
+    const Poly* toCompose = &stack->content[stack->size - composeDepth];
+    Poly composition = PolyCompose(&topPoly, composeDepth, toCompose);
 
+    for (size_t i = 0; i < composeDepth; i++) {
+        ExprRelease(PopExpr(stack));
+    }
+
+    PushPoly(stack, composition);
     PolyDestroy(&topPoly);
-    for (size_t i = 0; i < composeDepth; i++)
-        PolyDestroy(&toCompose[i]);
+}
+
+/** Number of random points checked by CHECK_MUL and CHECK_COMPOSE by default. */
+#define CHECK_DEFAULT_ROUNDS 4
+
+/**
+ * Parses parameters of a CHECK command: @p required ones followed by an optional
+ * positive number of rounds.
+ * @param[in] command : command
+ * @param[in] nameLength : length of the command name
+ * @param[in] required : number of required parameters
+ * @param[in] params : destination for @p required parameters and the number of rounds
+ * @return Are parameters valid?
+ */
+static bool CommandCheckParameters(const char* command, size_t nameLength, size_t required, size_t params[]) {
+    size_t count = 0;
+    size_t* parsed = NULL;
+
+    if (strlen(command) > nameLength) {
+        parsed = CommandParameterList(command, nameLength + 1, &count);
+        if (!parsed)
+            return false;
+    }
+
+    bool valid = (count == required || (count == required + 1 && parsed[required] > 0));
+
+    params[required] = CHECK_DEFAULT_ROUNDS;
+    for (size_t i = 0; valid && i < count; i++)
+        params[i] = parsed[i];
+
+    free(parsed);
+
+    return valid;
+}
+
+static void ProcessCheckMulCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 9; // strlen("CHECK_MUL");
+    size_t rounds;
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (!CommandCheckParameters(command, nameLength, 0, &rounds)) {
+        PrintError(WRONG_CHECK_PARAMETER, lineNumber);
+        return;
+    } else if (stack->size < 3) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return;
+    }
+
+    StackForce(stack, 3);
+
+    const Poly* claimed = &stack->content[stack->size - 1];
+    const Poly* firstFactor = &stack->content[stack->size - 2];
+    const Poly* secondFactor = &stack->content[stack->size - 3];
+
+    PrintNumberLine(PolyCheckMul(firstFactor, secondFactor, claimed, rounds));
+}
+
+static void ProcessCheckComposeCommand(PolyStack* stack, char* command, int lineNumber) {
+    const size_t nameLength = 13; // strlen("CHECK_COMPOSE");
+    size_t params[2];
+
+    if (!CommandValidDelimeter(command, nameLength)) {
+        PrintError(WRONG_COMMAND, lineNumber);
+        return;
+    } else if (!CommandCheckParameters(command, nameLength, 1, params)) {
+        PrintError(WRONG_CHECK_PARAMETER, lineNumber);
+        return;
+    } else if (stack->size < 2 || stack->size - 2 < params[0]) {
+        PrintError(STACK_UNDERFLOW, lineNumber);
+        return;
+    }
+
+    size_t composeDepth = params[0];
+    StackForce(stack, 2);
+
+    const Poly* claimed = &stack->content[stack->size - 1];
+    const Poly* outer = &stack->content[stack->size - 2];
+    const Poly* toCompose = &stack->content[stack->size - 2 - composeDepth];
+
+    /* As in COMPOSE, only the inner polynomials substituted into the outer one are read */
+    size_t usedDepth = PolyVarCount(outer);
+    if (usedDepth > composeDepth)
+        usedDepth = composeDepth;
+    StackForceRange(stack, stack->size - 2 - composeDepth, usedDepth);
+
+    PrintNumberLine(PolyCheckCompose(outer, composeDepth, toCompose, claimed, params[1]));
 }
 
 /**
  * Performs a command based on its' name. If the command does not exist,
  * the custom calc error will be displayed.
  * @param[in] stack : stack wit polynomials
+ * @param[in] input : calculator input, from which a command may read further lines
  * @param[in] command : name of a command to process
  * @param[in] lineNumber : ordinal of a line
+ * @return number of further input lines consumed by the command
  */
-static void ProcessCommand(PolyStack* stack, char* command, int lineNumber) {
+static int ProcessCommand(PolyStack* stack, LineReader* input, char* command, int lineNumber) {
+    int consumedLines = 0;
+
     if (strcmp(command, "ZERO") == 0)
         ProcessZeroCommand(stack);
     else if (strcmp(command, "IS_COEFF") == 0)
@@ -276,58 +1089,47 @@ static void ProcessCommand(PolyStack* stack, char* command, int lineNumber) {
         ProcessDegByCommand(stack, command, lineNumber);
     else if (strncmp(command, "AT", 2) == 0) // 2 == strlen("AT")
         ProcessAtCommand(stack, command, lineNumber);
+    else if (strncmp(command, "SCALE", 5) == 0) // 5 == strlen("SCALE")
+        ProcessScaleCommand(stack, command, lineNumber);
     else if (strcmp(command, "PRINT") == 0)
         ProcessPrintCommand(stack, lineNumber);
+    else if (strncmp(command, "PRINT_FLAT", 10) == 0) // 10 == strlen("PRINT_FLAT")
+        ProcessPrintFlatCommand(stack, command, lineNumber);
     else if (strcmp(command, "POP") == 0)
         ProcessPopCommand(stack, lineNumber);
     else if (strncmp(command, "COMPOSE", 7) == 0) // 7 == strlen("COMPOSE")
         ProcessComposeCommand(stack, command, lineNumber);
+    else if (strncmp(command, "EVAL_MANY", 9) == 0) // 9 == strlen("EVAL_MANY")
+        consumedLines = ProcessEvalManyCommand(stack, input, command, lineNumber);
+    else if (strncmp(command, "EVALF", 5) == 0) // 5 == strlen("EVALF")
+        ProcessEvalDoubleCommand(stack, command, lineNumber);
+    else if (strncmp(command, "EVAL", 4) == 0) // 4 == strlen("EVAL")
+        ProcessEvalCommand(stack, command, lineNumber);
+    else if (strncmp(command, "PERMUTE", 7) == 0) // 7 == strlen("PERMUTE")
+        ProcessPermuteCommand(stack, command, lineNumber);
+    else if (strncmp(command, "CHECK_MUL", 9) == 0) // 9 == strlen("CHECK_MUL")
+        ProcessCheckMulCommand(stack, command, lineNumber);
+    else if (strncmp(command, "CHECK_COMPOSE", 13) == 0) // 13 == strlen("CHECK_COMPOSE")
+        ProcessCheckComposeCommand(stack, command, lineNumber);
+    else if (strncmp(command, "SAVE", 4) == 0) // 4 == strlen("SAVE")
+        ProcessSaveCommand(stack, command, lineNumber);
+    else if (strncmp(command, "LOAD", 4) == 0) // 4 == strlen("LOAD")
+        ProcessLoadCommand(stack, command, lineNumber);
+    else if (strncmp(command, "CHECKPOINT", 10) == 0) // 10 == strlen("CHECKPOINT")
+        ProcessCheckpointCommand(stack, command, lineNumber);
+    else if (strncmp(command, "FLAT", 4) == 0) // 4 == strlen("FLAT")
+        consumedLines = ProcessFlatCommand(stack, input, command, lineNumber);
     else
         PrintError(WRONG_COMMAND, lineNumber);
-}
 
-/**
- * Reads a command name to a @p command. Returns true if input is legal.
- * @param[in] command : destination for reading
- * @return Is input legal?
- */
-static bool ReadCommand(char** command) {
-    int curChar = getchar();
-    bool validChars = true;
-    size_t size = 0, capacity = 1;
-
-    while (curChar != EOF && curChar != '\n') {
-        validChars &= (curChar != '\0');
-
-        if (validChars) {
-            if (size + 1 == capacity) {
-                capacity = 2 * capacity + 1;
-                *command = realloc(*command, capacity * sizeof(char));
-                CHECK_NULL_PTR(*command);
-            }
-
-            (*command)[size++] = (char) curChar;
-        }
-        curChar =  getchar();
-    }
-
-    if (validChars)
-        (*command)[size] = '\0';
-
-    return validChars;
+    return consumedLines;
 }
 
-void ProcessCommandInput(PolyStack* stack, int lineNumber) {
-    errno = 0; /* The state could have been changed during the parsing. */
-
-    char* command = NULL;
-    bool successfulRead = ReadCommand(&command);
-
-    if (successfulRead) {
-        ProcessCommand(stack, command, lineNumber);
-    } else {
+int ProcessCommandInput(PolyStack* stack, LineReader* input, char* command, size_t length, int lineNumber) {
+    if (memchr(command, '\0', length)) {
         PrintError(WRONG_COMMAND, lineNumber);
+        return 0;
     }
 
-    free(command);
-}
\ No newline at end of file
+    return ProcessCommand(stack, input, command, lineNumber);
+}
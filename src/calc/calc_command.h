@@ -10,15 +10,20 @@
 #define POLYNOMIALS_CALC_COMMAND_H
 
 #include "../poly/poly_stack.h"
+#include "../poly/io/line_reader.h"
 
 /**
- * Signals calc in order to read a line representing a command.
+ * Signals calc in order to process a line representing a command.
  * In case of successful parsing command is processed on @p stack,
  * otherwise a custom calculator error will be displayed.
  * @param[in] stack: stack with polynomials
+ * @param[in] input : calculator input, from which the command may read further lines
+ * @param[in] command : line representing a command, read from @p input
+ * @param[in] length : number of characters of the line
  * @param[in] lineNumber : current ordinal of a line
+ * @return number of further lines consumed by the command
  */
-void ProcessCommandInput(PolyStack* stack, int lineNumber);
+int ProcessCommandInput(PolyStack* stack, LineReader* input, char* command, size_t length, int lineNumber);
 
 #endif //POLYNOMIALS_CALC_COMMAND_H
 
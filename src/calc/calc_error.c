@@ -6,28 +6,53 @@
   @date 2021
 */
 
-#include <stdio.h>
 #include "calc_error.h"
+#include "../poly/io/output_writer.h"
 
-void PrintError(CalcError error, int line) {
+/**
+ * Returns a description of an error.
+ * @param[in] error : error
+ * @return description printed after the line ordinal
+ */
+static const char* ErrorDescription(CalcError error) {
     switch (error) {
         case WRONG_POLY:
-            fprintf(stderr, "ERROR %d WRONG POLY\n", line);
-            break;
+            return "WRONG POLY";
         case WRONG_COMMAND:
-            fprintf(stderr, "ERROR %d WRONG COMMAND\n", line);
-            break;
+            return "WRONG COMMAND";
         case WRONG_AT_VALUE:
-            fprintf(stderr, "ERROR %d AT WRONG VALUE\n", line);
-            break;
+            return "AT WRONG VALUE";
+        case WRONG_SCALE_VALUE:
+            return "SCALE WRONG VALUE";
         case STACK_UNDERFLOW:
-            fprintf(stderr, "ERROR %d STACK UNDERFLOW\n", line);
-            break;
+            return "STACK UNDERFLOW";
         case WRONG_DEG_VARIABLE:
-            fprintf(stderr, "ERROR %d DEG BY WRONG VARIABLE\n", line);
-            break;
+            return "DEG BY WRONG VARIABLE";
         case WRONG_COMPOSE_PARAMETER:
-            fprintf(stderr, "ERROR %d COMPOSE WRONG PARAMETER\n", line);
-            break;
+            return "COMPOSE WRONG PARAMETER";
+        case WRONG_PERMUTE_PARAMETER:
+            return "PERMUTE WRONG PARAMETER";
+        case WRONG_EVAL_VALUE:
+            return "EVAL WRONG VALUE";
+        case WRONG_EVALF_VALUE:
+            return "EVALF WRONG VALUE";
+        case WRONG_CHECK_PARAMETER:
+            return "CHECK WRONG PARAMETER";
+        case WRONG_FLAT_VALUE:
+            return "FLAT WRONG VALUE";
+        case WRONG_FILE:
+            return "WRONG FILE";
     }
-}
\ No newline at end of file
+
+    return "";
+}
+
+void PrintError(CalcError error, int line) {
+    OutputWriter* writer = StandardError();
+
+    WriteString(writer, "ERROR ");
+    WriteLong(writer, line);
+    WriteChar(writer, ' ');
+    WriteString(writer, ErrorDescription(error));
+    WriteLineEnd(writer);
+}
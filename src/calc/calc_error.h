@@ -14,13 +14,20 @@ typedef enum CalcError {
     WRONG_POLY,
     WRONG_COMMAND,
     WRONG_AT_VALUE,
+    WRONG_SCALE_VALUE,
     STACK_UNDERFLOW,
     WRONG_DEG_VARIABLE,
-    WRONG_COMPOSE_PARAMETER
+    WRONG_COMPOSE_PARAMETER,
+    WRONG_PERMUTE_PARAMETER,
+    WRONG_EVAL_VALUE,
+    WRONG_EVALF_VALUE,
+    WRONG_CHECK_PARAMETER,
+    WRONG_FLAT_VALUE,
+    WRONG_FILE
 } CalcError;
 
 /**
- * Displays an error on stderr.
+ * Displays an error on stderr, through its buffered writer.
  * @param[in] error : error to print.
  * @param[in] line : line ordinal where error occurred.
  */
@@ -6,22 +6,129 @@
   @date 2021
 */
 
-
-#include "errno.h"
+#include <stdlib.h>
+#include <string.h>
 
 #include "calc_poly.h"
 #include "calc_error.h"
-#include "../poly/io/poly_io.h"
+#include "../poly/io/poly_parser.h"
+#include "../poly/poly_parallel.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Maximal number of lines of a batch. */
+#define BATCH_LINES 1024
+
+/** Maximal number of characters of a batch, longer lines are streamed. */
+#define BATCH_TEXT (1 << 20)
+
+/** Minimal number of characters of a batch parsed in parallel, smaller ones do not pay off waking workers. */
+#define BATCH_PARALLEL_TEXT (1 << 14)
+
+void PolyLineBatchInitialize(PolyLineBatch* batch) {
+    *batch = (PolyLineBatch) {.lines = NULL, .count = 0, .capacity = 0, .text = NULL, .textLength = 0};
+}
+
+/**
+ * Parses a single line of a batch.
+ * @param[in] taskID : index of the line
+ * @param[in] batch : pointer to PolyLineBatch
+ */
+static void ParseLineTask(size_t taskID, void* batch) {
+    PolyLine* line = &((PolyLineBatch*) batch)->lines[taskID];
+    line->correct = ParsePoly(line->line, line->length, &line->p, NULL);
+}
+
+void PolyLineBatchFlush(PolyStack* stack, PolyLineBatch* batch) {
+    if (batch->count > 1 && batch->textLength >= BATCH_PARALLEL_TEXT) {
+        ParallelFor(batch->count, ParseLineTask, batch);
+    } else {
+        for (size_t lineID = 0; lineID < batch->count; lineID++)
+            ParseLineTask(lineID, batch);
+    }
+
+    for (size_t lineID = 0; lineID < batch->count; lineID++) {
+        PolyLine* line = &batch->lines[lineID];
+
+        if (line->correct)
+            PushPoly(stack, line->p);
+        else
+            PrintError(WRONG_POLY, line->lineNumber);
+    }
+
+    batch->count = 0;
+    batch->textLength = 0;
+}
+
+void PolyLineBatchDestroy(PolyLineBatch* batch) {
+    free(batch->lines);
+    free(batch->text);
+}
+
+/**
+ * Adds a line to a batch, which has room for it.
+ * @param[in] batch : batch
+ * @param[in] line : characters of the line
+ * @param[in] length : number of characters of the line
+ * @param[in] keep : are the characters kept by the reader until the batch is flushed?
+ * @param[in] lineNumber : ordinal of the line
+ */
+static void PolyLineBatchAdd(PolyLineBatch* batch, const char* line, size_t length, bool keep, int lineNumber) {
+    if (batch->count == batch->capacity) {
+        batch->capacity = 2 * batch->capacity + 1;
+        batch->lines = realloc(batch->lines, batch->capacity * sizeof(PolyLine));
+        CHECK_NULL_PTR(batch->lines);
+    }
+
+    /* Copies share a buffer, which is allocated once, so they never move */
+    if (!keep) {
+        if (!batch->text) {
+            batch->text = malloc(BATCH_TEXT * sizeof(char));
+            CHECK_NULL_PTR(batch->text);
+        }
+
+        memcpy(&batch->text[batch->textLength], line, length * sizeof(char));
+        line = &batch->text[batch->textLength];
+    }
+
+    batch->lines[batch->count++] = (PolyLine) {.line = line, .length = length, .lineNumber = lineNumber};
+    batch->textLength += length;
+}
+
+void ProcessPolyInput(PolyStack* stack, PolyLineBatch* batch, LineReader* input, int lineNumber) {
+    char* part;
+    size_t length;
+    bool lineEnd = false;
+
+    if (!LineReaderNextPart(input, &part, &length, &lineEnd))
+        return;
+
+    if (lineEnd && length <= BATCH_TEXT) {
+        if (batch->count == BATCH_LINES || batch->textLength + length > BATCH_TEXT)
+            PolyLineBatchFlush(stack, batch);
+
+        /* Parts of a mapping stay valid until the reader is closed */
+        PolyLineBatchAdd(batch, part, length, input->mapped, lineNumber);
+        return;
+    }
+
+    /* Polynomials are pushed in the order of their lines */
+    PolyLineBatchFlush(stack, batch);
+
+    PolyStream stream;
+    PolyStreamInitialize(&stream);
+    PolyStreamFeed(&stream, part, length);
 
-void ProcessPolyInput(PolyStack* stack, int lineNumber) {
-    errno = 0; /* The state could have been changed during the parsing. */
+    /* Parts are parsed as they arrive, so the line is never held as a whole */
+    while (!lineEnd && LineReaderNextPart(input, &part, &length, &lineEnd))
+        PolyStreamFeed(&stream, part, length);
 
     Poly newPoly;
-    bool successfulRead = ReadPoly(&newPoly);
+    bool successfulRead = PolyStreamFinish(&stream, &newPoly, NULL);
 
     if (successfulRead) {
         PushPoly(stack, newPoly);
     } else {
         PrintError(WRONG_POLY, lineNumber);
     }
-}
\ No newline at end of file
+}
@@ -10,14 +10,61 @@
 #define POLYNOMIALS_CALC_POLY_H
 
 #include "../poly/poly_stack.h"
+#include "../poly/io/line_reader.h"
+
+/** Polynomial line waiting for a parallel parse. */
+typedef struct PolyLine {
+    const char* line;       ///< characters of the line
+    size_t      length;     ///< number of characters of the line
+    int         lineNumber; ///< ordinal of the line
+    bool        correct;    ///< was the line parsed correctly?
+    Poly        p;          ///< parsed polynomial
+} PolyLine;
+
+/**
+ * Type representing consecutive polynomial lines, which are parsed
+ * in parallel and pushed in their original order.
+ */
+typedef struct PolyLineBatch {
+    PolyLine* lines;      ///< waiting lines
+    size_t    count;      ///< number of waiting lines
+    size_t    capacity;   ///< number of lines which fit without reallocation
+    char*     text;       ///< copies of lines, which are not kept by the reader
+    size_t    textLength; ///< number of characters of the waiting lines
+} PolyLineBatch;
+
+/**
+ * Initializes an empty batch.
+ * @param[in] batch : batch to initialize
+ */
+void PolyLineBatchInitialize(PolyLineBatch* batch);
+
+/**
+ * Parses waiting lines, in parallel if there is enough text to pay off, and places
+ * them on @p stack in their original order. A custom calc error is displayed for
+ * every incorrect line.
+ * @param[in] stack : stack with polynomials
+ * @param[in] batch : batch, which becomes empty
+ */
+void PolyLineBatchFlush(PolyStack* stack, PolyLineBatch* batch);
+
+/**
+ * Clears memory allocated for an empty batch.
+ * @param[in] batch : batch
+ */
+void PolyLineBatchDestroy(PolyLineBatch* batch);
 
 /**
- * Signals calc in order to read a line representing a poly.
+ * Signals calc in order to parse the next line of @p input, which represents
+ * a poly. A short line is added to @p batch, which is flushed when it is full.
+ * A long one is parsed while it is read, part by part, after flushing the batch.
  * In case of successful parsing, the poly is placed on @p stack,
  * otherwise a custom calc error will be displayed.
  * @param[in] stack : stack with polynomials
+ * @param[in] batch : batch of waiting lines
+ * @param[in] input : reader positioned at the start of the line
  * @param[in] lineNumber : current ordinal of a line
  */
-void ProcessPolyInput(PolyStack* stack, int lineNumber);
+void ProcessPolyInput(PolyStack* stack, PolyLineBatch* batch, LineReader* input, int lineNumber);
 
 #endif //POLYNOMIALS_CALC_POLY_H
@@ -8,54 +8,96 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "calc/calc_poly.h"
 #include "calc/calc_command.h"
+#include "poly/io/poly_file.h"
 
-int PeekCharacter() {
-    int nextChar = getchar();
-    ungetc(nextChar, stdin);
-    return nextChar;
+bool LineHasNoInformation(int firstCharacter) {
+    return firstCharacter == '\n' || firstCharacter == '#';
 }
 
-bool HasNextLine() {
-    int peek = PeekCharacter();
-    return peek != EOF;
+bool LineRepresentsCommand(int firstCharacter) {
+    return isalpha(firstCharacter);
 }
 
-bool LineHasNoInformation() {
-    int peek = PeekCharacter();
-    return peek == '#' || peek == '\n';
-}
-
-bool LineRepresentsCommand() {
-    int peek = PeekCharacter();
-    return isalpha(peek);
-}
+/**
+ * Skips a line without reading it into memory as a whole.
+ * @param[in] input : reader
+ */
+static void IgnoreLine(LineReader* input) {
+    char* part;
+    size_t length;
+    bool lineEnd = false;
 
-void LineIgnore() {
-    int curChar = getchar();
-    while (curChar != EOF && curChar != '\n')
-        curChar = getchar();
+    while (!lineEnd && LineReaderNextPart(input, &part, &length, &lineEnd))
+        ;
 }
 
-int main(void) {
+int main(int argc, char* argv[]) {
     PolyStack stack;
     StackInitialize(&stack);
 
+    const char* inputPath = NULL;
+    const char* restorePath = NULL;
+
+    for (int argID = 1; argID < argc; argID++) {
+        if (strcmp(argv[argID], "--lazy") == 0) {
+            stack.lazy = true;
+        } else if (strcmp(argv[argID], "--restore") == 0 && argID + 1 < argc && !restorePath) {
+            restorePath = argv[++argID];
+        } else if (argv[argID][0] != '-' && !inputPath) {
+            inputPath = argv[argID];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[argID]);
+            StackDestroy(&stack);
+            return 1;
+        }
+    }
+
+    if (restorePath && !StackRestore(&stack, restorePath)) {
+        fprintf(stderr, "Cannot restore %s\n", restorePath);
+        StackDestroy(&stack);
+        return 1;
+    }
+
+    LineReader input;
+
+    if (!inputPath) {
+        LineReaderInitialize(&input, STDIN_FILENO);
+    } else if (!LineReaderOpen(&input, inputPath)) {
+        fprintf(stderr, "Cannot open %s\n", inputPath);
+        StackDestroy(&stack);
+        return 1;
+    }
+
+    PolyLineBatch batch;
+    PolyLineBatchInitialize(&batch);
+
     int lineNumber = 1;
+    int firstCharacter;
+    char* line;
+    size_t length;
 
-    while (HasNextLine()) {
-        if (LineHasNoInformation())
-            LineIgnore();
-        else if (LineRepresentsCommand())
-            ProcessCommandInput(&stack, lineNumber);
-        else // Line represents a poly.
-            ProcessPolyInput(&stack, lineNumber);
+    while ((firstCharacter = LineReaderPeek(&input)) != EOF) {
+        if (LineHasNoInformation(firstCharacter))
+            IgnoreLine(&input);
+        else if (LineRepresentsCommand(firstCharacter) && LineReaderNext(&input, &line, &length)) {
+            /* Commands see all polynomials of the preceding lines */
+            PolyLineBatchFlush(&stack, &batch);
+            lineNumber += ProcessCommandInput(&stack, &input, line, length, lineNumber);
+        } else { // Line represents a poly.
+            ProcessPolyInput(&stack, &batch, &input, lineNumber);
+        }
 
         lineNumber++;
     }
 
+    PolyLineBatchFlush(&stack, &batch);
+    PolyLineBatchDestroy(&batch);
+    LineReaderClose(&input);
     StackDestroy(&stack);
 
     return 0;
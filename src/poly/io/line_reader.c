@@ -0,0 +1,203 @@
+/** @file
+  Implementation of a buffered line reader.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "line_reader.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Initial size of a block buffer. */
+#define LINE_READER_BLOCK_SIZE (1 << 16)
+
+/**
+ * Maps the rest of a regular file to memory. Line feeds are replaced
+ * by null characters in a private copy of the touched pages.
+ * @param[in] reader : reader of the file
+ * @return Was the file mapped?
+ */
+static bool LineReaderMap(LineReader* reader) {
+    struct stat status;
+    if (fstat(reader->fd, &status) != 0 || !S_ISREG(status.st_mode))
+        return false;
+
+    off_t offset = lseek(reader->fd, 0, SEEK_CUR);
+    if (offset < 0 || offset >= status.st_size)
+        return false;
+
+    size_t size = (size_t) status.st_size;
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, reader->fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    reader->mapped = true;
+    reader->atEnd = true;
+    reader->data = data;
+    reader->start = (size_t) offset;
+    reader->end = reader->capacity = size;
+
+    return true;
+}
+
+void LineReaderInitialize(LineReader* reader, int fd) {
+    *reader = (LineReader) {
+        .fd = fd,
+        .ownsFd = false,
+        .mapped = false,
+        .atEnd = false,
+        .data = NULL,
+        .start = 0,
+        .end = 0,
+        .capacity = 0,
+        .tail = NULL
+    };
+
+    LineReaderMap(reader);
+}
+
+bool LineReaderOpen(LineReader* reader, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    LineReaderInitialize(reader, fd);
+    reader->ownsFd = true;
+
+    return true;
+}
+
+/**
+ * Reads the next block of a source, keeping the characters which were not
+ * handed out yet. There is always room for a null character after the block.
+ * @param[in] reader : reader, which is not a mapping
+ * @return Were any characters read?
+ */
+static bool LineReaderFill(LineReader* reader) {
+    if (reader->atEnd)
+        return false;
+
+    if (reader->start > 0) {
+        memmove(reader->data, &reader->data[reader->start], reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+
+    /* Buffer grows only for lines longer than a half of it */
+    if (2 * reader->end >= reader->capacity) {
+        reader->capacity = (reader->capacity > 0 ? 2 * reader->capacity : LINE_READER_BLOCK_SIZE);
+        reader->data = realloc(reader->data, reader->capacity * sizeof(char));
+        CHECK_NULL_PTR(reader->data);
+    }
+
+    ssize_t count;
+    do {
+        count = read(reader->fd, &reader->data[reader->end], reader->capacity - reader->end - 1);
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) {
+        reader->atEnd = true;
+        return false;
+    }
+
+    reader->end += (size_t) count;
+
+    return true;
+}
+
+/**
+ * Finds the first line feed of a reader's data, starting from an index.
+ * @param[in] reader : reader
+ * @param[in] from : index to start from
+ * @return pointer to the line feed or NULL if there is none
+ */
+static char* LineReaderFindLineFeed(const LineReader* reader, size_t from) {
+    return (from < reader->end ? memchr(&reader->data[from], '\n', reader->end - from) : NULL);
+}
+
+bool LineReaderNext(LineReader* reader, char** line, size_t* length) {
+    size_t scanned = 0; /* Characters after start, which are known not to be line feeds */
+    char* lineFeed = LineReaderFindLineFeed(reader, reader->start);
+
+    while (!lineFeed) {
+        scanned = reader->end - reader->start;
+        if (!LineReaderFill(reader))
+            break;
+        lineFeed = LineReaderFindLineFeed(reader, reader->start + scanned);
+    }
+
+    if (!lineFeed && reader->start == reader->end)
+        return false;
+
+    *line = &reader->data[reader->start];
+    *length = (lineFeed ? (size_t) (lineFeed - *line) : reader->end - reader->start);
+
+    if (lineFeed) {
+        *lineFeed = '\0';
+    } else if (!reader->mapped) {
+        reader->data[reader->end] = '\0';
+    } else {
+        /* A mapping may end exactly at a page end, so the last line is copied */
+        free(reader->tail);
+        reader->tail = malloc((*length + 1) * sizeof(char));
+        CHECK_NULL_PTR(reader->tail);
+
+        memcpy(reader->tail, *line, *length * sizeof(char));
+        reader->tail[*length] = '\0';
+        *line = reader->tail;
+    }
+
+    reader->start += *length + (lineFeed ? 1 : 0);
+
+    return true;
+}
+
+int LineReaderPeek(LineReader* reader) {
+    if (reader->start == reader->end && !LineReaderFill(reader))
+        return EOF;
+
+    return (unsigned char) reader->data[reader->start];
+}
+
+bool LineReaderNextPart(LineReader* reader, char** part, size_t* length, bool* lineEnd) {
+    /* Refilling an exhausted buffer moves nothing, so the buffer does not grow */
+    if (reader->start == reader->end && !LineReaderFill(reader))
+        return false;
+
+    char* lineFeed = LineReaderFindLineFeed(reader, reader->start);
+
+    *part = &reader->data[reader->start];
+    *length = (lineFeed ? (size_t) (lineFeed - *part) : reader->end - reader->start);
+    *lineEnd = (lineFeed != NULL);
+
+    reader->start += *length + (lineFeed ? 1 : 0);
+
+    return true;
+}
+
+void LineReaderClose(LineReader* reader) {
+    if (reader->mapped)
+        munmap(reader->data, reader->capacity);
+    else
+        free(reader->data);
+
+    free(reader->tail);
+
+    if (reader->ownsFd)
+        close(reader->fd);
+}
@@ -0,0 +1,83 @@
+/** @file
+  Interface of a buffered line reader.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_LINE_READER_H
+#define POLYNOMIALS_LINE_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Type representing a source of lines. Regular files are mapped to memory,
+ * other sources are read in large blocks. Lines are handed out as slices
+ * of the reader's memory, so reading a line allocates nothing.
+ */
+typedef struct LineReader {
+    int    fd;       ///< descriptor of the source
+    bool   ownsFd;   ///< should the descriptor be closed with the reader?
+    bool   mapped;   ///< is @p data a memory mapping of the whole source?
+    bool   atEnd;    ///< has the end of the source been reached?
+    char*  data;     ///< mapping or block buffer
+    size_t start;    ///< index of the first character not handed out yet
+    size_t end;      ///< index after the last character available in @p data
+    size_t capacity; ///< size of @p data
+    char*  tail;     ///< copy of the last line of a mapping, which has no room for a null character
+} LineReader;
+
+/**
+ * Initializes a reader of an open descriptor, which stays open when the reader is closed.
+ * @param[in] reader : reader to initialize
+ * @param[in] fd : descriptor to read from
+ */
+void LineReaderInitialize(LineReader* reader, int fd);
+
+/**
+ * Initializes a reader of a file.
+ * @param[in] reader : reader to initialize
+ * @param[in] path : path to the file
+ * @return Was the file opened?
+ */
+bool LineReaderOpen(LineReader* reader, const char* path);
+
+/**
+ * Returns the next line without its line feed. The line is ended with
+ * a null character and stays valid until the next call on the reader.
+ * @param[in] reader : reader
+ * @param[out] line : destination for the line
+ * @param[out] length : destination for the number of characters of the line
+ * @return Was there a line to read?
+ */
+bool LineReaderNext(LineReader* reader, char** line, size_t* length);
+
+/**
+ * Returns the first character of the next line without consuming it.
+ * @param[in] reader : reader
+ * @return character or EOF if there are no more lines
+ */
+int LineReaderPeek(LineReader* reader);
+
+/**
+ * Returns the next part of the current line, without reading the rest of the
+ * line into memory. The part stays valid until the next call on the reader,
+ * and unlike a line it is not ended with a null character.
+ * @param[in] reader : reader
+ * @param[out] part : destination for the part
+ * @param[out] length : destination for the number of characters of the part
+ * @param[out] lineEnd : destination for the information whether the part
+ * ends the line, i.e. its line feed was consumed
+ * @return Was there a part to read? Otherwise the line was ended by the end of the source.
+ */
+bool LineReaderNextPart(LineReader* reader, char** part, size_t* length, bool* lineEnd);
+
+/**
+ * Releases resources of a reader.
+ * @param[in] reader : reader
+ */
+void LineReaderClose(LineReader* reader);
+
+#endif //POLYNOMIALS_LINE_READER_H
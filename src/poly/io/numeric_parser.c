@@ -6,83 +6,181 @@
   @date 2021
 */
 
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <limits.h>
-#include <errno.h>
 #include <string.h>
 
 #include "numeric_parser.h"
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
-static char* ExtractSubstring(const char* source, size_t from, size_t to) {
-    const int numberLength = (int) (to - from);
+/** Number of digits converted at once by the SWAR fast path. */
+#define SWAR_DIGITS 8
+
+/** Length of a real number, which is parsed without allocating a copy. */
+#define INLINE_NUMBER_LENGTH 128
+
+/* Bytes of a word are combined in the order of digits only on little-endian machines */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_ENABLED 1
+#else
+#define SWAR_ENABLED 0
+#endif
+
+/**
+ * Converts eight characters to a number, if all of them are digits.
+ * Digits are checked and combined in pairs, quadruples and octets
+ * within a single 64-bit word.
+ * @param[in] digits : characters
+ * @param[out] value : number represented by the characters
+ * @return Are all characters digits?
+ */
+static inline bool SwarEightDigits(const char* digits, uint64_t* value) {
+    uint64_t word;
+    memcpy(&word, digits, sizeof(word));
+
+    /* Each byte is in [0x30, 0x39] iff its high nibble is 3 and adding 6 keeps it */
+    uint64_t highNibbles = (word & 0xF0F0F0F0F0F0F0F0) |
+                           (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4);
+    if (highNibbles != 0x3333333333333333)
+        return false;
+
+    word -= 0x3030303030303030;
+    word = (word * 10) + (word >> 8);
+    word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+            (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+
+    *value = word;
+    return true;
+}
+
+/**
+ * Converts a sequence of digits to a number not greater than @p max.
+ * @param[in] digits : characters
+ * @param[in] count : number of characters
+ * @param[in] max : maximal value of the number
+ * @param[out] magnitude : parsed number
+ * @return status of parsing
+ */
+static NumberStatus DigitsToMagnitude(const char* digits, size_t count, uint64_t max, uint64_t* magnitude) {
+    const uint64_t swarBase = 100000000; // 10^SWAR_DIGITS
+    bool overflow = false;
+    uint64_t value = 0;
+    size_t i = 0;
+
+    if (count == 0)
+        return NUMBER_INVALID;
+
+    for (; SWAR_ENABLED && i + SWAR_DIGITS <= count; i += SWAR_DIGITS) {
+        uint64_t octet;
+        if (!SwarEightDigits(&digits[i], &octet))
+            break;
+
+        overflow |= (value > (max - octet) / swarBase);
+        value = value * swarBase + octet;
+    }
 
-    if (numberLength < 0)
-        return NULL;
+    for (; i < count; i++) {
+        if (!isdigit((unsigned char) digits[i]))
+            return NUMBER_INVALID;
 
-    char* numberString = malloc((numberLength + 1) * sizeof(char));
-    CHECK_NULL_PTR(numberString);
+        uint64_t digit = (uint64_t) (digits[i] - '0');
+        overflow |= (value > (max - digit) / 10);
+        value = value * 10 + digit;
+    }
 
-    memcpy(numberString, &source[from], numberLength * sizeof(char));
-    numberString[numberLength] = '\0';
+    *magnitude = value;
 
-    return numberString;
+    return (overflow ? NUMBER_OVERFLOW : NUMBER_OK);
 }
 
-static size_t StringToULL(const char* numberString, size_t max) {
-    if (!numberString) {
-        errno = EINVAL;
+/**
+ * Parses a range of characters onto a non-negative number.
+ * @param[in] source : word
+ * @param[in] from : including start
+ * @param[in] to : excluding end
+ * @param[in] max : maximal value of the number
+ * @param[in] status : destination for an error
+ * @return parsed number or zero in case of an error
+ */
+static uint64_t SubstringToUnsigned(const char* source, size_t from, size_t to, uint64_t max, NumberStatus* status) {
+    uint64_t magnitude = 0;
+    NumberStatus result = (from <= to ? DigitsToMagnitude(&source[from], to - from, max, &magnitude) : NUMBER_INVALID);
+
+    if (result != NUMBER_OK) {
+        *status = result;
         return 0;
     }
 
-    const int base = 10;
-    size_t parsedNumber = strtoull(numberString, NULL, base);
+    return magnitude;
+}
 
-    if (numberString[0] == '-' || parsedNumber > max)
-        errno = ERANGE;
+size_t SubstringToParameter(const char* source, size_t from, size_t to, NumberStatus* status) {
+    return (size_t) SubstringToUnsigned(source, from, to, SIZE_MAX, status);
+}
 
-    return parsedNumber;
+poly_exp_t SubstringToExp(const char* source, size_t from, size_t to, NumberStatus* status) {
+    return (poly_exp_t) SubstringToUnsigned(source, from, to, INT_MAX, status);
 }
 
-static long StringToLong(char* numberString) {
-    if (!numberString) {
-        errno = EINVAL;
-        return 0;
-    }
+poly_coeff_t SubstringToCoeff(const char* source, size_t from, size_t to, NumberStatus* status) {
+    bool negative = (from < to && source[from] == '-');
+    uint64_t max = (negative ? (uint64_t) LONG_MAX + 1 : LONG_MAX);
+    uint64_t magnitude = SubstringToUnsigned(source, from + negative, to, max, status);
 
-    const int base = 10;
-    long parsedNumber = strtol(numberString, NULL, base);
+    /* The magnitude of the least number does not fit in poly_coeff_t */
+    return (negative && magnitude > 0 ? -(poly_coeff_t) (magnitude - 1) - 1 : (poly_coeff_t) magnitude);
+}
 
-    return parsedNumber;
+/**
+ * Checks whether a string starts like a decimal number, i.e. not with
+ * a whitespace, a plus sign, an infinity or a NaN.
+ * @param[in] numberString : string
+ * @return Does the string start like a decimal number?
+ */
+static bool StartsAsDecimal(const char* numberString) {
+    if (numberString[0] == '-')
+        numberString++;
+    return isdigit(numberString[0]) || numberString[0] == '.';
 }
 
-size_t SubstringToParameter(const char* source, size_t from, size_t to) {
-    char* stringVariable = ExtractSubstring(source, from, to);
-    size_t parsedVariable = StringToULL(stringVariable, ULLONG_MAX);
+double SubstringToDouble(const char* source, size_t from, size_t to, NumberStatus* status) {
+    if (from > to) {
+        *status = NUMBER_INVALID;
+        return 0;
+    }
 
-    if (stringVariable)
-        free(stringVariable);
+    /* A copy ended with a null character is needed by strtod, long ones are rare */
+    const size_t length = to - from;
+    char inlineNumber[INLINE_NUMBER_LENGTH];
+    char* stringNumber = (length < INLINE_NUMBER_LENGTH ? inlineNumber : malloc((length + 1) * sizeof(char)));
+    CHECK_NULL_PTR(stringNumber);
 
-    return parsedVariable;
-}
+    memcpy(stringNumber, &source[from], length * sizeof(char));
+    stringNumber[length] = '\0';
 
-poly_exp_t SubstringToExp(const char* source, size_t from, size_t to) {
-    char* stringExp = ExtractSubstring(source, from, to);
-    poly_exp_t parsedExp = (poly_exp_t) StringToULL(stringExp, INT_MAX);
+    char* numberEnd = NULL;
+    double parsedNumber = 0;
 
-    if (stringExp)
-        free(stringExp);
+    /* Range errors of strtod are only reported through errno */
+    int savedErrno = errno;
+    errno = 0;
 
-    return parsedExp;
-}
+    if (StartsAsDecimal(stringNumber))
+        parsedNumber = strtod(stringNumber, &numberEnd);
 
-poly_coeff_t SubstringToCoeff(const char* source, size_t from, size_t to) {
-    char* stringCoeff = ExtractSubstring(source, from, to);
-    poly_coeff_t parsedCoeff = StringToLong(stringCoeff);
+    if (!numberEnd || *numberEnd != '\0')
+        *status = NUMBER_INVALID;
+    else if (errno == ERANGE)
+        *status = NUMBER_OVERFLOW;
 
-    if (stringCoeff)
-        free(stringCoeff);
+    errno = savedErrno;
 
-    return parsedCoeff;
+    if (stringNumber != inlineNumber)
+        free(stringNumber);
+
+    return parsedNumber;
 }
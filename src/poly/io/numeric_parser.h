@@ -11,34 +11,56 @@
 
 #include "../poly.h"
 
+/** Results of parsing a number. */
+typedef enum NumberStatus {
+    NUMBER_OK,      ///< characters represent a number
+    NUMBER_INVALID, ///< characters do not represent a number
+    NUMBER_OVERFLOW ///< number is out of the range of its type
+} NumberStatus;
+
 /**
  * Parses a range [@p from, @p to) of characters from @p source onto DegBy/PolyCompose argument.
- * In case of an size_t type overflow, errno is modified and zero is returned.
+ * In case of an error, @p status is set and zero is returned, otherwise @p status is not changed,
+ * so that a single status may collect errors of many numbers.
  * @param[in] source : word
  * @param[in] from : including start
  * @param[in] to : excluding end
+ * @param[in] status : destination for an error
  * @return parsed parameter
  */
-size_t SubstringToParameter(const char* source, size_t from, size_t to);
+size_t SubstringToParameter(const char* source, size_t from, size_t to, NumberStatus* status);
 
 /**
  * Parses a range [@p from, @p to) of characters from @p source onto polynomial exponent.
- * In case of an poly_exp_t type overflow, errno is modified and zero is returned.
+ * Errors are reported as by SubstringToParameter.
  * @param[in] source : word
  * @param[in] from : including start
  * @param[in] to : excluding end
- * @return parsed coefficient
+ * @param[in] status : destination for an error
+ * @return parsed exponent
  */
-poly_exp_t SubstringToExp(const char* source, size_t from, size_t to);
+poly_exp_t SubstringToExp(const char* source, size_t from, size_t to, NumberStatus* status);
 
 /**
  * Parses a range [@p from, @p to) of characters from @p source onto polynomial coefficient.
- * In case of an poly_coeff_t type overflow, errno is modified and zero is returned.
+ * Errors are reported as by SubstringToParameter.
  * @param[in] source : word
  * @param[in] from : including start
  * @param[in] to : excluding end
+ * @param[in] status : destination for an error
  * @return parsed coefficient
  */
-poly_coeff_t SubstringToCoeff(const char* source, size_t from, size_t to);
+poly_coeff_t SubstringToCoeff(const char* source, size_t from, size_t to, NumberStatus* status);
+
+/**
+ * Parses a range [@p from, @p to) of characters from @p source onto a real number.
+ * Errors are reported as by SubstringToParameter, a number out of the range of double is an overflow.
+ * @param[in] source : word
+ * @param[in] from : including start
+ * @param[in] to : excluding end
+ * @param[in] status : destination for an error
+ * @return parsed number
+ */
+double SubstringToDouble(const char* source, size_t from, size_t to, NumberStatus* status);
 
 #endif //POLYNOMIALS_NUMERIC_PARSER_H
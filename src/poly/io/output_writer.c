@@ -0,0 +1,221 @@
+/** @file
+  Implementation of a buffered output writer.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "output_writer.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Size of the buffer of the standard output. */
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+/** Size of the buffer of the standard error output. */
+#define ERROR_BUFFER_SIZE (1 << 16)
+
+/** Size of the buffer of a file. */
+#define FILE_BUFFER_SIZE (1 << 16)
+
+/** Two digit decimal representations of numbers from 0 to 99. */
+static const char digitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+/** Buffer of the standard output. */
+static char outputData[OUTPUT_BUFFER_SIZE];
+
+/** Buffer of the standard error output. */
+static char errorData[ERROR_BUFFER_SIZE];
+
+/** Writer of the standard output. */
+static OutputWriter outputWriter = {
+    .fd = STDOUT_FILENO, .data = outputData, .length = 0, .capacity = OUTPUT_BUFFER_SIZE
+};
+
+/** Writer of the standard error output. */
+static OutputWriter errorWriter = {
+    .fd = STDERR_FILENO, .data = errorData, .length = 0, .capacity = ERROR_BUFFER_SIZE
+};
+
+/** Have the writers been prepared for use? */
+static bool writersReady = false;
+
+/**
+ * Flushes both writers, called at the exit of the program.
+ */
+static void WritersFlushAtExit(void) {
+    WriterFlush(&errorWriter);
+    WriterFlush(&outputWriter);
+}
+
+/**
+ * Checks which outputs are terminals and schedules flushing at exit.
+ */
+static void WritersPrepare(void) {
+    if (writersReady)
+        return;
+
+    writersReady = true;
+    outputWriter.lineBuffered = isatty(outputWriter.fd);
+    errorWriter.lineBuffered = isatty(errorWriter.fd);
+
+    /* Messages printed by stdio before, e.g. by failed assertions, come first */
+    fflush(NULL);
+    atexit(WritersFlushAtExit);
+}
+
+OutputWriter* StandardOutput(void) {
+    WritersPrepare();
+    return &outputWriter;
+}
+
+OutputWriter* StandardError(void) {
+    WritersPrepare();
+    return &errorWriter;
+}
+
+bool WriterOpen(OutputWriter* writer, const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+        return false;
+
+    char* data = malloc(FILE_BUFFER_SIZE * sizeof(char));
+    CHECK_NULL_PTR(data);
+
+    *writer = (OutputWriter) {
+        .fd = fd,
+        .lineBuffered = false,
+        .data = data,
+        .length = 0,
+        .capacity = FILE_BUFFER_SIZE,
+        .failed = false
+    };
+
+    return true;
+}
+
+/**
+ * Writes characters directly to the output of a writer.
+ * @param[in] writer : writer
+ * @param[in] chars : characters
+ * @param[in] length : number of characters
+ */
+static void WriterWriteAll(OutputWriter* writer, const char* chars, size_t length) {
+    while (length > 0) {
+        ssize_t count = write(writer->fd, chars, length);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count <= 0) {
+            writer->failed = true; // Output is lost, as with a closed stdio stream.
+            return;
+        }
+
+        chars += count;
+        length -= (size_t) count;
+    }
+}
+
+void WriterFlush(OutputWriter* writer) {
+    WriterWriteAll(writer, writer->data, writer->length);
+    writer->length = 0;
+}
+
+bool WriterSync(OutputWriter* writer) {
+    WriterFlush(writer);
+
+    if (fsync(writer->fd) != 0)
+        writer->failed = true;
+
+    return !writer->failed;
+}
+
+bool WriterClose(OutputWriter* writer) {
+    WriterFlush(writer);
+    free(writer->data);
+
+    bool closed = (close(writer->fd) == 0);
+    return closed && !writer->failed;
+}
+
+void WriteChars(OutputWriter* writer, const char* chars, size_t length) {
+    if (length > writer->capacity - writer->length) {
+        WriterFlush(writer);
+
+        /* Characters which would fill the whole buffer bypass it */
+        if (length >= writer->capacity) {
+            WriterWriteAll(writer, chars, length);
+            return;
+        }
+    }
+
+    memcpy(&writer->data[writer->length], chars, length * sizeof(char));
+    writer->length += length;
+}
+
+void WriteString(OutputWriter* writer, const char* string) {
+    WriteChars(writer, string, strlen(string));
+}
+
+void WriteLong(OutputWriter* writer, long value) {
+    char digits[24];
+    char* end = &digits[sizeof(digits)];
+    char* begin = end;
+
+    /* Magnitude of the lowest long does not fit in a long */
+    unsigned long magnitude = (value < 0 ? 0UL - (unsigned long) value : (unsigned long) value);
+
+    /* Digits are produced in pairs, from the least significant ones */
+    while (magnitude >= 100) {
+        const char* pair = &digitPairs[2 * (magnitude % 100)];
+        magnitude /= 100;
+        *--begin = pair[1];
+        *--begin = pair[0];
+    }
+
+    if (magnitude >= 10) {
+        const char* pair = &digitPairs[2 * magnitude];
+        *--begin = pair[1];
+        *--begin = pair[0];
+    } else {
+        *--begin = (char) ('0' + magnitude);
+    }
+
+    if (value < 0)
+        *--begin = '-';
+
+    WriteChars(writer, begin, (size_t) (end - begin));
+}
+
+void WriteDouble(OutputWriter* writer, double value) {
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%.17g", value);
+    WriteChars(writer, digits, (size_t) length);
+}
+
+void WriteLineEnd(OutputWriter* writer) {
+    WriteChar(writer, '\n');
+
+    if (writer->lineBuffered)
+        WriterFlush(writer);
+}
@@ -0,0 +1,116 @@
+/** @file
+  Interface of a buffered output writer.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_OUTPUT_WRITER_H
+#define POLYNOMIALS_OUTPUT_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Type representing an output, which is written in large blocks. A writer
+ * is flushed when its buffer fills up and when the program exits, and
+ * a writer of a terminal also at the end of every line.
+ */
+typedef struct OutputWriter {
+    int    fd;           ///< descriptor of the output
+    bool   lineBuffered; ///< should every line be flushed?
+    char*  data;         ///< buffer
+    size_t length;       ///< number of characters in the buffer
+    size_t capacity;     ///< size of the buffer
+    bool   failed;       ///< has writing to the output failed?
+} OutputWriter;
+
+/**
+ * Returns the writer of the standard output.
+ * @return writer
+ */
+OutputWriter* StandardOutput(void);
+
+/**
+ * Returns the writer of the standard error output.
+ * @return writer
+ */
+OutputWriter* StandardError(void);
+
+/**
+ * Initializes a writer of a file, which is created or truncated.
+ * @param[in] writer : writer to initialize
+ * @param[in] path : path to the file
+ * @return Was the file opened?
+ */
+bool WriterOpen(OutputWriter* writer, const char* path);
+
+/**
+ * Flushes a writer of a file and waits until its content is stored on the device.
+ * @param[in] writer : writer initialized by WriterOpen
+ * @return Were all characters written and stored?
+ */
+bool WriterSync(OutputWriter* writer);
+
+/**
+ * Flushes a writer of a file and releases its resources.
+ * @param[in] writer : writer initialized by WriterOpen
+ * @return Were all characters written to the file?
+ */
+bool WriterClose(OutputWriter* writer);
+
+/**
+ * Writes characters.
+ * @param[in] writer : writer
+ * @param[in] chars : characters
+ * @param[in] length : number of characters
+ */
+void WriteChars(OutputWriter* writer, const char* chars, size_t length);
+
+/**
+ * Writes a single character.
+ * @param[in] writer : writer
+ * @param[in] c : character
+ */
+static inline void WriteChar(OutputWriter* writer, char c) {
+    if (writer->length == writer->capacity)
+        WriteChars(writer, &c, 1);
+    else
+        writer->data[writer->length++] = c;
+}
+
+/**
+ * Writes a string.
+ * @param[in] writer : writer
+ * @param[in] string : string ended with a null character
+ */
+void WriteString(OutputWriter* writer, const char* string);
+
+/**
+ * Writes an integer in decimal notation.
+ * @param[in] writer : writer
+ * @param[in] value : integer
+ */
+void WriteLong(OutputWriter* writer, long value);
+
+/**
+ * Writes a real number as the printf format "%.17g" does.
+ * @param[in] writer : writer
+ * @param[in] value : real number
+ */
+void WriteDouble(OutputWriter* writer, double value);
+
+/**
+ * Ends a line, flushing a line buffered writer.
+ * @param[in] writer : writer
+ */
+void WriteLineEnd(OutputWriter* writer);
+
+/**
+ * Writes buffered characters to the output.
+ * @param[in] writer : writer
+ */
+void WriterFlush(OutputWriter* writer);
+
+#endif //POLYNOMIALS_OUTPUT_WRITER_H
@@ -0,0 +1,269 @@
+/** @file
+  Implementation of binary polynomial files.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "poly_file.h"
+#include "output_writer.h"
+#include "../poly_serial.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Signature at the start of a polynomial file, which includes the version of the format. */
+static const uint8_t polyFileMagic[] = {'P', 'O', 'L', 'Y', 'B', 'I', 'N', '1'};
+
+/** Length of the signature. */
+#define POLY_FILE_MAGIC_LENGTH sizeof(polyFileMagic)
+
+/** Signature at the start of a checkpoint file, which includes the version of the format. */
+static const uint8_t checkpointMagic[] = {'P', 'O', 'L', 'Y', 'S', 'T', 'K', '1'};
+
+/** Length of the header of a checkpoint file, i.e. its signature and the number of entries. */
+#define CHECKPOINT_HEADER_LENGTH (sizeof(checkpointMagic) + 8)
+
+/** Length of an entry of the table of a checkpoint file, i.e. its position and length. */
+#define CHECKPOINT_ENTRY_LENGTH 16
+
+/**
+ * Writes a number as eight bytes, from the least significant one.
+ * @param[in] dest : destination
+ * @param[in] v : number
+ */
+static void WriteUint64(uint8_t* dest, uint64_t v) {
+    for (size_t byteID = 0; byteID < 8; byteID++)
+        dest[byteID] = (uint8_t) (v >> (8 * byteID));
+}
+
+/**
+ * Reads a number written by WriteUint64.
+ * @param[in] source : bytes
+ * @return number
+ */
+static uint64_t ReadUint64(const uint8_t* source) {
+    uint64_t v = 0;
+    for (size_t byteID = 0; byteID < 8; byteID++)
+        v |= (uint64_t) source[byteID] << (8 * byteID);
+    return v;
+}
+
+bool PolySave(const Poly* p, const char* path) {
+    OutputWriter file;
+    if (!WriterOpen(&file, path))
+        return false;
+
+    size_t size = PolySerializedSize(p);
+    uint8_t* bytes = malloc(size);
+    CHECK_NULL_PTR(bytes);
+    PolySerialize(p, bytes);
+
+    WriteChars(&file, (const char*) polyFileMagic, POLY_FILE_MAGIC_LENGTH);
+    WriteChars(&file, (const char*) bytes, size);
+    free(bytes);
+
+    return WriterClose(&file);
+}
+
+bool PolyLoad(const char* path, Poly* p) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) ||
+        (size_t) status.st_size <= POLY_FILE_MAGIC_LENGTH) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t) status.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    size_t consumed = 0;
+    bool correct = (memcmp(data, polyFileMagic, POLY_FILE_MAGIC_LENGTH) == 0 &&
+                    PolyDeserialize((const uint8_t*) data + POLY_FILE_MAGIC_LENGTH,
+                                    size - POLY_FILE_MAGIC_LENGTH, p, &consumed));
+
+    /* Trailing bytes mean that the file is not what it claims to be */
+    if (correct && consumed != size - POLY_FILE_MAGIC_LENGTH) {
+        PolyDestroy(p);
+        correct = false;
+    }
+
+    munmap(data, size);
+
+    return correct;
+}
+
+/**
+ * Returns the binary representation of an entry of a stack, which has not been read yet.
+ * @param[in] stack : stack
+ * @param[in] entryID : index of the entry
+ * @return expression of the representation or NULL if there is none
+ */
+static const PolyExpr* StackEntrySerial(const PolyStack* stack, size_t entryID) {
+    const PolyExpr* e = stack->exprs[entryID];
+    return (e && e->kind == EXPR_SERIAL && !e->forced ? e : NULL);
+}
+
+/**
+ * Returns the polynomial of an entry of a stack, materializing it if needed.
+ * @param[in] stack : stack
+ * @param[in] entryID : index of the entry
+ * @return polynomial
+ */
+static const Poly* StackEntryPoly(PolyStack* stack, size_t entryID) {
+    PolyExpr* e = stack->exprs[entryID];
+    return (e ? ExprForce(e) : &stack->content[entryID]);
+}
+
+/**
+ * Writes a checkpoint file.
+ * @param[in] stack : stack
+ * @param[in] lengths : lengths of binary representations of entries
+ * @param[in] file : writer of the file
+ */
+static void CheckpointWrite(PolyStack* stack, const size_t* lengths, OutputWriter* file) {
+    uint8_t number[8];
+
+    WriteChars(file, (const char*) checkpointMagic, sizeof(checkpointMagic));
+    WriteUint64(number, stack->size);
+    WriteChars(file, (const char*) number, sizeof(number));
+
+    size_t offset = CHECKPOINT_HEADER_LENGTH + stack->size * CHECKPOINT_ENTRY_LENGTH;
+    size_t longest = 0;
+
+    for (size_t entryID = 0; entryID < stack->size; entryID++) {
+        WriteUint64(number, offset);
+        WriteChars(file, (const char*) number, sizeof(number));
+        WriteUint64(number, lengths[entryID]);
+        WriteChars(file, (const char*) number, sizeof(number));
+
+        offset += lengths[entryID];
+        if (lengths[entryID] > longest)
+            longest = lengths[entryID];
+    }
+
+    uint8_t* bytes = malloc(longest + 1);
+    CHECK_NULL_PTR(bytes);
+
+    for (size_t entryID = 0; entryID < stack->size; entryID++) {
+        /* Entries, which were restored and not read since, are copied as they are */
+        const PolyExpr* serial = StackEntrySerial(stack, entryID);
+
+        if (serial) {
+            WriteChars(file, (const char*) serial->serial, lengths[entryID]);
+        } else {
+            PolySerialize(StackEntryPoly(stack, entryID), bytes);
+            WriteChars(file, (const char*) bytes, lengths[entryID]);
+        }
+    }
+
+    free(bytes);
+}
+
+bool StackCheckpoint(PolyStack* stack, const char* path) {
+    size_t* lengths = malloc((stack->size + 1) * sizeof(size_t));
+    CHECK_NULL_PTR(lengths);
+
+    for (size_t entryID = 0; entryID < stack->size; entryID++) {
+        const PolyExpr* serial = StackEntrySerial(stack, entryID);
+        lengths[entryID] = (serial ? serial->serialLength : PolySerializedSize(StackEntryPoly(stack, entryID)));
+    }
+
+    size_t pathLength = strlen(path);
+    char* temporaryPath = malloc(pathLength + sizeof(".tmp"));
+    CHECK_NULL_PTR(temporaryPath);
+    memcpy(temporaryPath, path, pathLength);
+    memcpy(&temporaryPath[pathLength], ".tmp", sizeof(".tmp"));
+
+    OutputWriter file;
+    bool opened = WriterOpen(&file, temporaryPath);
+    bool written = false;
+
+    /* The content is stored before the rename, so a crash cannot leave a short checkpoint under the path */
+    if (opened) {
+        CheckpointWrite(stack, lengths, &file);
+        written = WriterSync(&file);
+        written = (WriterClose(&file) && written);
+    }
+
+    if (written)
+        written = (rename(temporaryPath, path) == 0);
+
+    if (!written && opened)
+        unlink(temporaryPath);
+
+    free(temporaryPath);
+    free(lengths);
+
+    return written;
+}
+
+bool StackRestore(PolyStack* stack, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) ||
+        (size_t) status.st_size < CHECKPOINT_HEADER_LENGTH) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t) status.st_size;
+    uint8_t* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    uint64_t count = ReadUint64(&data[sizeof(checkpointMagic)]);
+    bool correct = (memcmp(data, checkpointMagic, sizeof(checkpointMagic)) == 0 &&
+                    count <= (size - CHECKPOINT_HEADER_LENGTH) / CHECKPOINT_ENTRY_LENGTH);
+
+    /* Entries are checked without building their polynomials, which happens when they are needed */
+    size_t dataStart = CHECKPOINT_HEADER_LENGTH + (correct ? count : 0) * CHECKPOINT_ENTRY_LENGTH;
+
+    for (uint64_t entryID = 0; correct && entryID < count; entryID++) {
+        const uint8_t* tableEntry = &data[CHECKPOINT_HEADER_LENGTH + entryID * CHECKPOINT_ENTRY_LENGTH];
+        uint64_t offset = ReadUint64(tableEntry);
+        uint64_t length = ReadUint64(&tableEntry[8]);
+
+        correct = (offset >= dataStart && offset <= size && length <= size - offset &&
+                   PolySerialCheck(&data[offset], length));
+    }
+
+    if (!correct) {
+        munmap(data, size);
+        return false;
+    }
+
+    StackAdoptSnapshot(stack, data, size);
+
+    for (uint64_t entryID = 0; entryID < count; entryID++) {
+        const uint8_t* tableEntry = &data[CHECKPOINT_HEADER_LENGTH + entryID * CHECKPOINT_ENTRY_LENGTH];
+        PushExpr(stack, ExprFromSerialized(&data[ReadUint64(tableEntry)], ReadUint64(&tableEntry[8])));
+    }
+
+    return true;
+}
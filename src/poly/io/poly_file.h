@@ -0,0 +1,57 @@
+/** @file
+  Interface of binary polynomial files.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_FILE_H
+#define POLYNOMIALS_POLY_FILE_H
+
+#include "../poly.h"
+#include "../poly_stack.h"
+
+/**
+ * Writes a polynomial to a file in the binary representation, preceded
+ * by a signature of the format. A failed write, e.g. on a full disk, is reported.
+ * @param[in] p : polynomial
+ * @param[in] path : path to the file, which is created or truncated
+ * @return Was the file written?
+ */
+bool PolySave(const Poly* p, const char* path);
+
+/**
+ * Reads a polynomial from a file written by PolySave. The file is mapped
+ * to memory and the polynomial is read directly from the mapping.
+ * @param[in] path : path to the file
+ * @param[out] p : read polynomial
+ * @return Was the file a correct polynomial file?
+ */
+bool PolyLoad(const char* path, Poly* p);
+
+/**
+ * Writes all entries of a stack to a checkpoint file, from the bottom one.
+ * The file starts with a signature, the number of entries and a table of
+ * positions and lengths of their binary representations, so a single entry
+ * can be found without reading the others. The file is written under
+ * a temporary name, stored on the device and only then renamed, so it may
+ * replace the checkpoint, which the stack was restored from.
+ * @param[in] stack : stack
+ * @param[in] path : path to the file
+ * @return Was the file written?
+ */
+bool StackCheckpoint(PolyStack* stack, const char* path);
+
+/**
+ * Pushes entries of a checkpoint file onto a stack. The file is mapped
+ * to memory and every entry is checked in a single pass, which builds
+ * nothing, while its polynomial is read from the mapping when it is needed
+ * for the first time. A damaged entry makes the whole file incorrect.
+ * @param[in] stack : stack without a restored checkpoint
+ * @param[in] path : path to the file
+ * @return Was the file a correct checkpoint file?
+ */
+bool StackRestore(PolyStack* stack, const char* path);
+
+#endif //POLYNOMIALS_POLY_FILE_H
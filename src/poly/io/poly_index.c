@@ -0,0 +1,175 @@
+/** @file
+  Implementation of a structural index of polynomial lines.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "poly_index.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Number of characters classified at once. */
+#define INDEX_BLOCK 64
+
+/** Classes of characters of a block, as bitmasks with a bit per character. */
+typedef struct BlockMasks {
+    uint64_t structural; ///< parentheses, commas and plus signs
+    uint64_t numeric;    ///< digits and minus signs
+} BlockMasks;
+
+#if defined(__SSE2__)
+/** Number of characters classified by a single vector comparison. */
+#define INDEX_SLICE 16
+
+/**
+ * Classifies a slice of a block with vector comparisons.
+ * @param[in] slice : characters
+ * @param[in] shift : index of the first character of the slice in its block
+ * @param[in] masks : masks of the block to update
+ */
+static inline void ClassifySlice(const char* slice, size_t shift, BlockMasks* masks) {
+    __m128i chars = _mm_loadu_si128((const __m128i*) slice);
+    __m128i parenthesis = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('(')),
+                                       _mm_cmpeq_epi8(chars, _mm_set1_epi8(')')));
+    __m128i separator = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(',')),
+                                     _mm_cmpeq_epi8(chars, _mm_set1_epi8('+')));
+
+    /* Digits are exactly the characters, whose unsigned distance from '0' is at most 9 */
+    __m128i offset = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset);
+    __m128i numeric = _mm_or_si128(digit, _mm_cmpeq_epi8(chars, _mm_set1_epi8('-')));
+    __m128i structural = _mm_or_si128(parenthesis, separator);
+
+    masks->structural |= (uint64_t) (unsigned) _mm_movemask_epi8(structural) << shift;
+    masks->numeric |= (uint64_t) (unsigned) _mm_movemask_epi8(numeric) << shift;
+}
+
+/**
+ * Classifies characters of a block.
+ * @param[in] block : characters
+ * @param[out] masks : masks of the block
+ */
+static void ClassifyBlock(const char* block, BlockMasks* masks) {
+    *masks = (BlockMasks) {.structural = 0, .numeric = 0};
+
+    for (size_t shift = 0; shift < INDEX_BLOCK; shift += INDEX_SLICE)
+        ClassifySlice(&block[shift], shift, masks);
+}
+#else
+/**
+ * Classifies characters of a block.
+ * @param[in] block : characters
+ * @param[out] masks : masks of the block
+ */
+static void ClassifyBlock(const char* block, BlockMasks* masks) {
+    *masks = (BlockMasks) {.structural = 0, .numeric = 0};
+
+    for (size_t i = 0; i < INDEX_BLOCK; i++) {
+        const uint64_t bit = (uint64_t) 1 << i;
+        const char c = block[i];
+
+        masks->structural |= (c == '(' || c == ')' || c == ',' || c == '+' ? bit : 0);
+        masks->numeric |= ((c >= '0' && c <= '9') || c == '-' ? bit : 0);
+    }
+}
+#endif
+
+/**
+ * Counts set bits of a mask.
+ * @param[in] mask : mask
+ * @return number of set bits
+ */
+static inline size_t CountBits(uint64_t mask) {
+#if defined(__GNUC__)
+    return (size_t) __builtin_popcountll(mask);
+#else
+    size_t count = 0;
+    for (; mask; mask &= mask - 1)
+        count++;
+    return count;
+#endif
+}
+
+/**
+ * Finds the lowest set bit of a non-zero mask.
+ * @param[in] mask : mask
+ * @return index of the bit
+ */
+static inline size_t LowestBit(uint64_t mask) {
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctzll(mask);
+#else
+    size_t bit = 0;
+    for (; !(mask & 1); mask >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+
+/**
+ * Appends positions of structural characters of a block to an index.
+ * @param[in] index : index
+ * @param[in] base : index of the first character of the block
+ * @param[in] structural : mask of structural characters of the block
+ */
+static void PolyIndexAppend(PolyIndex* index, size_t base, uint64_t structural) {
+    size_t required = index->count + CountBits(structural);
+
+    if (required > index->capacity) {
+        index->capacity = 2 * required;
+        index->positions = realloc(index->positions, index->capacity * sizeof(size_t));
+        CHECK_NULL_PTR(index->positions);
+    }
+
+    for (; structural; structural &= structural - 1)
+        index->positions[index->count++] = base + LowestBit(structural);
+}
+
+void PolyIndexInitialize(PolyIndex* index) {
+    *index = (PolyIndex) {.positions = NULL, .count = 0, .capacity = 0};
+}
+
+bool PolyIndexBuild(PolyIndex* index, const char* source, size_t length, size_t* errorPosition) {
+    char padded[INDEX_BLOCK];
+    index->count = 0;
+
+    for (size_t base = 0; base < length; base += INDEX_BLOCK) {
+        const char* block = &source[base];
+
+        /* The last block is padded with digits, which are neither structural nor wrong */
+        if (length - base < INDEX_BLOCK) {
+            memset(padded, '0', INDEX_BLOCK);
+            memcpy(padded, block, length - base);
+            block = padded;
+        }
+
+        BlockMasks masks;
+        ClassifyBlock(block, &masks);
+
+        uint64_t wrong = ~(masks.structural | masks.numeric);
+        if (wrong) {
+            if (errorPosition)
+                *errorPosition = base + LowestBit(wrong);
+            return false;
+        }
+
+        PolyIndexAppend(index, base, masks.structural);
+    }
+
+    return true;
+}
+
+void PolyIndexDestroy(PolyIndex* index) {
+    free(index->positions);
+    PolyIndexInitialize(index);
+}
@@ -0,0 +1,51 @@
+/** @file
+  Interface of a structural index of polynomial lines.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_INDEX_H
+#define POLYNOMIALS_POLY_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Type representing positions of structural characters of a polynomial
+ * line, i.e. parentheses, commas and plus signs. Characters between two
+ * consecutive structural ones form a number.
+ */
+typedef struct PolyIndex {
+    size_t* positions; ///< increasing indexes of structural characters
+    size_t  count;     ///< number of structural characters
+    size_t  capacity;  ///< number of positions which fit without reallocation
+} PolyIndex;
+
+/**
+ * Initializes an empty index.
+ * @param[in] index : index to initialize
+ */
+void PolyIndexInitialize(PolyIndex* index);
+
+/**
+ * Builds a structural index of a part of a line, classifying its characters
+ * in blocks. Checks that the part consists of characters which may represent
+ * a polynomial. Previous content of the index is replaced, reusing its memory.
+ * @param[in] index : initialized index
+ * @param[in] source : characters
+ * @param[in] length : number of characters
+ * @param[out] errorPosition : destination for the index of the first wrong
+ * character in case of an error, may be NULL
+ * @return Did the characters pass the check?
+ */
+bool PolyIndexBuild(PolyIndex* index, const char* source, size_t length, size_t* errorPosition);
+
+/**
+ * Clears memory allocated for an index.
+ * @param[in] index : index
+ */
+void PolyIndexDestroy(PolyIndex* index);
+
+#endif //POLYNOMIALS_POLY_INDEX_H
@@ -6,194 +6,140 @@
   @date 2021
 */
 
-#include <errno.h>
-#include <stdio.h>
-#include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
+#include <string.h>
 
 #include "poly_io.h"
 #include "poly_parser.h"
+#include "../poly_terms.h"
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
+/** Number of nesting levels printed without allocating memory. */
+#define PRINT_STACK_DEPTH 32
+
+/** Sum of monomials, which is being printed. */
+typedef struct PrintFrame {
+    const Poly* p;    ///< sum
+    size_t      next; ///< index of the monomial being printed
+} PrintFrame;
+
 /**
- * Prints monomial.
- * @param[in] m : monomial
+ * Ends a monomial of a frame, whose coefficient has been printed.
+ * @param[in] writer : writer
+ * @param[in] frame : frame
  */
-static void MonoPrint(const Mono* m) {
-    printf("(");
-    PolyPrint(&m->p);
-    printf(",%d)", m->exp);
+static void PrintMonoEnd(OutputWriter* writer, PrintFrame* frame) {
+    WriteChar(writer, ',');
+    WriteLong(writer, frame->p->arr[frame->next++].exp);
+    WriteChar(writer, ')');
 }
 
 void PolyPrint(const Poly* p) {
+    OutputWriter* writer = StandardOutput();
+
     if (PolyIsCoeff(p)) {
-        printf("%ld", p->coeff);
+        WriteLong(writer, p->coeff);
         return;
     }
 
-    for (size_t curMonoID = 0; curMonoID < p->size; curMonoID++) {
-        MonoPrint(&p->arr[curMonoID]);
+    PrintFrame initialFrames[PRINT_STACK_DEPTH];
+    PrintFrame* frames = initialFrames;
+    size_t capacity = PRINT_STACK_DEPTH;
+    size_t depth = 0;
 
-        /* Only print plus sign if the monomial wasn't last */
-        if (curMonoID < p->size - 1)
-            printf("+");
-    }
-}
+    frames[depth++] = (PrintFrame) {.p = p, .next = 0};
 
-/**
- * Checks whether a correct input line can contain character @p cur after @p prev.
- * @param[in] cur : current character
- * @param[in] prev : previous character
- * @param[in] lastNonDigit : last non-digit character
- * @return Can @p cur be after @p prev?
- */
-static bool IsValidPolyCharAfter(char cur, char prev, char lastNonDigit) {
-    /* Variable to check whether prev refers to a digit of a coefficient */
-    bool prevCoeff = (lastNonDigit == '(' || lastNonDigit == '-');
-
-    if (isdigit(prev))
-        return isdigit(cur) || (prevCoeff ? cur == ',' : cur == ')');
-
-    switch (prev) {
-        case '(':
-            return (isdigit(cur) || cur == '-') || cur == '(';
-        case ')':
-            return cur == ',' || cur == '+';
-        case ',':
-            return isdigit(cur) && !prevCoeff;
-        case '-':
-            return isdigit(cur) && prevCoeff;
-        case '+':
-            return cur == '(';
-        default:
-            return false;
-    }
-}
+    /* Sums are printed with an explicit stack of frames instead of recursion */
+    while (depth > 0) {
+        PrintFrame* frame = &frames[depth - 1];
 
-/**
- * Checks whether @p stringPoly represents a correct non-constant polynomial.
- * @param[in] stringPoly : sequence of characters
- * @param[in] length : lengths of the sequence
- * @return Does @p stringPoly represent a correct non-constant polynomial?
- */
-static bool IsCorrectNonCoeffPoly(const char* stringPoly, size_t length) {
-    /* Each non-constant polynomial has parenthesis from the both sides */
-    if (stringPoly[0] != '(' || stringPoly[length - 1] != ')')
-        return false;
+        if (frame->next == frame->p->size) {
+            if (--depth > 0)
+                PrintMonoEnd(writer, &frames[depth - 1]);
+            continue;
+        }
 
-    int parenthesis = 1; // stringPoly[0] == '('
-    char lastNonDigit = '(';
+        const Mono* m = &frame->p->arr[frame->next];
 
-    for (size_t i = 1; i < length; i++) {
-        char curChar = stringPoly[i];
-        char prevChar = stringPoly[i - 1];
+        /* Only print plus sign if the monomial wasn't first */
+        if (frame->next > 0)
+            WriteChar(writer, '+');
+        WriteChar(writer, '(');
 
-        if (!IsValidPolyCharAfter(curChar, prevChar, lastNonDigit))
-            return false;
+        if (PolyIsCoeff(&m->p)) {
+            WriteLong(writer, m->p.coeff);
+            PrintMonoEnd(writer, frame);
+            continue;
+        }
 
-        if (curChar == '(')
-            parenthesis++;
-        else if (curChar == ')')
-            parenthesis--;
+        if (depth == capacity) {
+            capacity *= 2;
+            if (frames == initialFrames) {
+                frames = malloc(capacity * sizeof(PrintFrame));
+                CHECK_NULL_PTR(frames);
+                memcpy(frames, initialFrames, depth * sizeof(PrintFrame));
+            } else {
+                frames = realloc(frames, capacity * sizeof(PrintFrame));
+                CHECK_NULL_PTR(frames);
+            }
+        }
 
-        if (!isdigit(curChar))
-            lastNonDigit = curChar;
+        frames[depth++] = (PrintFrame) {.p = &m->p, .next = 0};
     }
 
-    return parenthesis == 0;
+    if (frames != initialFrames)
+        free(frames);
 }
 
-/**
- * Checks whether @p stringPoly represents a correct constant polynomial.
- * @param[in] stringPoly : sequence of characters
- * @param[in] length : lengths of the sequence
- * @return Does @p stringPoly represent a correct constant polynomial?
- */
-static bool IsCorrectCoeffPoly(const char* stringPoly, size_t length) {
-    if (stringPoly[0] == '-' && length == 1)
-        return false;
-
-    for (size_t i = 0; i < length; i++) {
-        bool validChar = isdigit(stringPoly[i]) || (i == 0 && stringPoly[i] == '-');
-
-        if (!validChar)
-            return false;
+void PolyPrintFlat(const Poly* p, OutputWriter* writer) {
+    if (PolyIsCoeff(p)) {
+        if (!PolyIsZero(p)) {
+            WriteLong(writer, p->coeff);
+            WriteLineEnd(writer);
+        }
+        return;
     }
 
-    return true;
-}
+    /* Frames on the path to a constant coefficient hold exponents of its record */
+    size_t vars = PolyVarCount(p);
+    PrintFrame* frames = malloc(vars * sizeof(PrintFrame));
+    CHECK_NULL_PTR(frames);
+    size_t depth = 0;
 
-/**
- * Checks whether @p stringPoly represents a correct polynomial.
- * @param[in] stringPoly : sequence of characters
- * @param[in] length : lengths of the sequence
- * @return Does @p stringPoly represent a correct polynomial?
- */
-static bool IsCorrectPoly(const char* stringPoly, size_t length) {
-    if (IsCorrectCoeffPoly(stringPoly, length))
-        return true;
-    return IsCorrectNonCoeffPoly(stringPoly, length);
-}
+    frames[depth++] = (PrintFrame) {.p = p, .next = 0};
 
-static bool IsValidPolyChar(int curChar) {
-    return curChar == '(' || curChar == ')' || curChar == ',' ||
-           curChar == '+' || curChar == '-' || isdigit(curChar);
-}
+    while (depth > 0) {
+        PrintFrame* frame = &frames[depth - 1];
 
-/**
- * Reads a line representing a polynomial to @p buffer.
- * @param[in] buffer: buffer for unparsed polynomial.
- * @return Was the read successful?
- */
-static bool ReadStringPoly(char** buffer) {
-    int curChar = getchar();
-    bool validChars = true;
-    size_t size = 0, capacity = 1;
-
-    while (curChar != EOF && curChar != '\n') {
-        validChars &= IsValidPolyChar(curChar);
-        if (validChars) {
-            if (size + 1 == capacity) {
-                capacity = 2 * capacity + 1;
-                *buffer = realloc(*buffer, capacity * sizeof(char));
-                CHECK_NULL_PTR(*buffer);
-            }
-
-            (*buffer)[size++] = (char) curChar;
+        if (frame->next == frame->p->size) {
+            if (--depth > 0)
+                frames[depth - 1].next++;
+            continue;
         }
-        curChar = getchar();
-    }
 
-    if (validChars)
-        (*buffer)[size] = '\0';
+        const Mono* m = &frame->p->arr[frame->next];
 
-    return validChars;
-}
+        if (!PolyIsCoeff(&m->p)) {
+            frames[depth++] = (PrintFrame) {.p = &m->p, .next = 0};
+            continue;
+        }
 
-bool ReadPoly(Poly* p) {
-    char* buffer = NULL;
-    bool successfulRead = ReadStringPoly(&buffer);
+        WriteLong(writer, m->p.coeff);
+        for (size_t var = 0; var < depth; var++) {
+            WriteChar(writer, ' ');
+            WriteLong(writer, frames[var].p->arr[frames[var].next].exp);
+        }
+        for (size_t var = depth; var < vars; var++)
+            WriteChars(writer, " 0", 2);
+        WriteLineEnd(writer);
 
-    if (!successfulRead) {
-        free(buffer);
-        return false;
+        frame->next++;
     }
 
-    size_t size = strlen(buffer);
-    bool correctPolyInput = IsCorrectPoly(buffer, size);
-
-    if (correctPolyInput)
-        *p = SubstringToPoly(buffer, 0, size);
-
-    /* SubstringToPoly could have modified errno state */
-    bool successfulParsing = (errno == 0);
-
-    if (!successfulParsing)
-        PolyDestroy(p);
-
-    free(buffer);
+    free(frames);
+}
 
-    return correctPolyInput && successfulParsing;
+bool ReadPoly(const char* line, size_t length, Poly* p, size_t* errorPosition) {
+    return ParsePoly(line, length, p, errorPosition);
 }
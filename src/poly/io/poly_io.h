@@ -10,13 +10,18 @@
 #define POLYNOMIALS_POLY_IO_H
 
 #include "../poly.h"
+#include "output_writer.h"
 
 /**
- * Reads polynomial to @p p from standard input.
+ * Reads polynomial to @p p from a line.
+ * @param[in] line : line representing a polynomial
+ * @param[in] length : number of characters of the line
  * @param[in] p : polynomial
+ * @param[in] errorPosition : destination for the index of the first wrong
+ * character of an incorrect line, may be NULL
  * @return Successful read?
  */
-bool ReadPoly(Poly* p);
+bool ReadPoly(const char* line, size_t length, Poly* p, size_t* errorPosition);
 
 /**
  * Prints polynomial.
@@ -24,4 +29,13 @@ bool ReadPoly(Poly* p);
  */
 void PolyPrint(const Poly *p);
 
+/**
+ * Prints polynomial as flat records, one term @f$c x_0^{e_0} x_1^{e_1} \ldots@f$
+ * per line in the form "c e0 e1 ...". All records have exponents of every
+ * variable of the polynomial and follow in increasing order of exponent vectors.
+ * @param[in] p : polynomial
+ * @param[in] writer : destination of the records
+ */
+void PolyPrintFlat(const Poly* p, OutputWriter* writer);
+
 #endif //POLYNOMIALS_POLY_IO_H
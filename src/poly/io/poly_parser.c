@@ -6,114 +6,289 @@
   @date 2021
 */
 
-#include <errno.h>
-#include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "poly_parser.h"
 #include "numeric_parser.h"
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
+/** Number of characters indexed at once, which bounds the size of the index. */
+#define STREAM_WINDOW (1 << 16)
+
+void PolyStreamInitialize(PolyStream* stream) {
+    *stream = (PolyStream) {
+        .state = STREAM_POLY,
+        .frames = NULL,
+        .depth = 0,
+        .capacity = 0,
+        .value = PolyZero(),
+        .exp = 0,
+        .number = NULL,
+        .numberLength = 0,
+        .numberStart = 0,
+        .carry = NULL,
+        .carryCapacity = 0,
+        .consumed = 0,
+        .errorPosition = 0
+    };
+
+    PolyIndexInitialize(&stream->index);
+}
+
 /**
- * Parses a range [@p from, @p to) of characters from @p source onto monomial.
- * @param[in] source : word
- * @param[in] from : including start
- * @param[in] to : excluding end
- * @return parsed monomial
+ * Marks the line as incorrect, unless an earlier error was found.
+ * @param[in] stream : parser
+ * @param[in] position : position of the wrong character
  */
-static Mono SubstringToMono(const char* source, size_t from, size_t to) {
-    /* First digit of an exponent is at most in index (to - 1) */
-    size_t expStartIdx = to - 1;
-
-    /* Reducing expStartIdx until it points to a first digit of an exponent */
-    while (source[expStartIdx - 1] != ',')
-        expStartIdx--;
-
-    /* Coefficient is in range [from + 1, expStartIdx - 1) */
-    return (Mono) {
-            .exp = SubstringToExp(source, expStartIdx, to),
-            .p = SubstringToPoly(source, from + 1, expStartIdx - 1)
-    };
+static void StreamFail(PolyStream* stream, size_t position) {
+    if (stream->state == STREAM_ERROR)
+        return;
+
+    stream->state = STREAM_ERROR;
+    stream->errorPosition = position;
 }
 
 /**
- * Gives index of of an end of the polynomial starting from @p pos in @p source.
- * @param[in] source : word
- * @param[in] pos : starting position of a polynomial
- * @return index of a closing parenthesis
+ * Starts parsing of a sum of monomials.
+ * @param[in] stream : parser
  */
-static size_t FindParenthesisBalancePosition(const char* source, size_t pos) {
-    size_t depth = 0; /* Recursion depth of a polynomial */
-
-    do {
-        if (source[pos] == '(')
-            depth++;
-        else if (source[pos] == ')')
-            depth--;
-        pos++;
-    } while (depth > 0);
-
-    return pos; // source[pos - 1] == ')'
+static void StreamPushFrame(PolyStream* stream) {
+    if (stream->depth == stream->capacity) {
+        stream->capacity = 2 * stream->capacity + 1;
+        stream->frames = realloc(stream->frames, stream->capacity * sizeof(ParseFrame));
+        CHECK_NULL_PTR(stream->frames);
+    }
+
+    stream->frames[stream->depth++] = (ParseFrame) {.monos = NULL, .size = 0, .capacity = 0};
 }
 
 /**
- * Parses a range [@p from, @p to) of characters from @p source onto non-constant poly.
- * @param[in] source : word
- * @param[in] from : including start
- * @param[in] to : excluding end
- * @return parsed monomial
+ * Appends a monomial to the innermost sum. Takes @p m on property.
+ * @param[in] stream : parser
+ * @param[in] m : monomial
  */
-static Poly SubstringToNonCoeffPoly(const char* source, size_t from, size_t to) {
-    Mono* monos = NULL;
-    size_t size = 0, capacity = 1;
-
-    for (size_t i = from; i < to; i++) {
-        size_t monoStartIdx = i;
-        size_t monoEndIdx = FindParenthesisBalancePosition(source, i);
-
-        if (size + 1 == capacity) {
-            capacity = 2 * capacity + 1;
-            monos = realloc(monos, capacity * sizeof(Mono));
-            CHECK_NULL_PTR(monos);
-        }
+static void StreamAppendMono(PolyStream* stream, Mono m) {
+    ParseFrame* frame = &stream->frames[stream->depth - 1];
 
-        /* Range [monoStartIdx, monoEndIdx) now contains monomial */
-        monos[size++] = SubstringToMono(source, monoStartIdx, monoEndIdx);
-        i = monoEndIdx;
+    if (frame->size == frame->capacity) {
+        frame->capacity = 2 * frame->capacity + 1;
+        frame->monos = realloc(frame->monos, frame->capacity * sizeof(Mono));
+        CHECK_NULL_PTR(frame->monos);
     }
 
-    Poly resPoly = PolyAddMonos(size, monos);
-    free(monos);
+    frame->monos[frame->size++] = m;
+}
+
+/**
+ * Ends parsing of the innermost sum.
+ * @param[in] stream : parser
+ * @return sum of parsed monomials
+ */
+static Poly StreamPopFrame(PolyStream* stream) {
+    ParseFrame* frame = &stream->frames[--stream->depth];
+    return PolyOwnMonos(frame->size, frame->monos);
+}
+
+/**
+ * Appends characters to the copy of the number being read.
+ * @param[in] stream : parser
+ * @param[in] chars : characters
+ * @param[in] length : number of characters
+ * @param[in] carried : number of characters of the copy to keep
+ */
+static void StreamCarry(PolyStream* stream, const char* chars, size_t length, size_t carried) {
+    if (carried + length > stream->carryCapacity) {
+        stream->carryCapacity = 2 * (carried + length);
+        stream->carry = realloc(stream->carry, stream->carryCapacity * sizeof(char));
+        CHECK_NULL_PTR(stream->carry);
+    }
 
-    return resPoly;
+    memcpy(&stream->carry[carried], chars, length * sizeof(char));
+    stream->number = stream->carry;
+    stream->numberLength = carried + length;
 }
 
+/**
+ * Consumes characters of a number, i.e. digits and minus signs.
+ * @param[in] stream : parser
+ * @param[in] chars : characters
+ * @param[in] length : number of characters
+ * @param[in] position : position of the first character in the line
+ */
+static void StreamNumber(PolyStream* stream, const char* chars, size_t length, size_t position) {
+    if (stream->state != STREAM_POLY && stream->state != STREAM_EXP) {
+        StreamFail(stream, position);
+        return;
+    }
+
+    if (stream->numberLength == 0) {
+        stream->number = chars;
+        stream->numberLength = length;
+        stream->numberStart = position;
+    } else {
+        /* Only a number, which was carried from the previous part, may continue */
+        StreamCarry(stream, chars, length, stream->numberLength);
+    }
+}
 
 /**
- * Checks whether a range [@p from, @p to) of characters from @p source represent a number.
- * @param[in] source : word
- * @param[in] from : including start
- * @param[in] to : excluding end
- * @return is range a number?
+ * Ends the number being read, which is either a coefficient or an exponent.
+ * @param[in] stream : parser
  */
-static bool SubstringIsNumber(const char* source, size_t from, size_t to) {
-    /* As source represents a correct polynomial, we can only check the corner values */
-    return (isdigit(source[from]) || source[from] == '-') && isdigit(source[to - 1]);
+static void StreamEndNumber(PolyStream* stream) {
+    NumberStatus status = NUMBER_OK;
+
+    if (stream->state == STREAM_POLY) {
+        stream->value = PolyFromCoeff(SubstringToCoeff(stream->number, 0, stream->numberLength, &status));
+        stream->state = STREAM_VALUE;
+    } else {
+        stream->exp = SubstringToExp(stream->number, 0, stream->numberLength, &status);
+        stream->state = STREAM_MONO_END;
+    }
+
+    stream->numberLength = 0;
+
+    if (status != NUMBER_OK)
+        StreamFail(stream, stream->numberStart);
 }
 
-Poly SubstringToPoly(const char* source, size_t from, size_t to) {
-    assert(from <= to);
+/**
+ * Consumes a structural character, i.e. a parenthesis, a comma or a plus sign.
+ * @param[in] stream : parser
+ * @param[in] c : character
+ * @param[in] position : position of the character in the line
+ */
+static void StreamStructural(PolyStream* stream, char c, size_t position) {
+    if (stream->numberLength > 0)
+        StreamEndNumber(stream);
 
-    /* In case of failed parsing zero polynomial is returned */
-    if (errno)
-        return PolyZero();
+    for (;;) {
+        switch (stream->state) {
+            case STREAM_POLY:
+                /* Parenthesis at the start of a polynomial opens a sum and its first monomial */
+                if (c != '(')
+                    break;
+                StreamPushFrame(stream);
+                return;
+            case STREAM_VALUE:
+                /* The polynomial is a coefficient of a monomial, unless it is the whole line */
+                if (c != ',' || stream->depth == 0)
+                    break;
+                stream->state = STREAM_EXP;
+                return;
+            case STREAM_MONO_END:
+                if (c != ')')
+                    break;
+                StreamAppendMono(stream, (Mono) {.exp = stream->exp, .p = stream->value});
+                stream->value = PolyZero();
+                stream->state = STREAM_MONO;
+                return;
+            case STREAM_MONO:
+                if (c == '+') {
+                    stream->state = STREAM_NEXT_MONO;
+                    return;
+                }
 
-    if (SubstringIsNumber(source, from, to)) {
-        poly_coeff_t coeff = SubstringToCoeff(source, from, to);
-        return PolyFromCoeff(coeff);
+                /* Anything else closes the sum, which is a coefficient of the enclosing monomial */
+                stream->value = StreamPopFrame(stream);
+                stream->state = STREAM_VALUE;
+                continue;
+            case STREAM_NEXT_MONO:
+                if (c != '(')
+                    break;
+                stream->state = STREAM_POLY;
+                return;
+            default:
+                break;
+        }
+
+        StreamFail(stream, position);
+        return;
+    }
+}
+
+/**
+ * Consumes characters in a single pass over their structural index.
+ * @param[in] stream : parser
+ * @param[in] window : characters
+ * @param[in] length : number of characters, at most @p STREAM_WINDOW
+ */
+static void StreamWindow(PolyStream* stream, const char* window, size_t length) {
+    size_t wrong;
+    if (!PolyIndexBuild(&stream->index, window, length, &wrong)) {
+        StreamFail(stream, stream->consumed + wrong);
+        return;
+    }
+
+    size_t pos = 0;
+
+    for (size_t i = 0; i < stream->index.count && stream->state != STREAM_ERROR; i++) {
+        size_t structural = stream->index.positions[i];
+
+        if (structural > pos)
+            StreamNumber(stream, &window[pos], structural - pos, stream->consumed + pos);
+
+        StreamStructural(stream, window[structural], stream->consumed + structural);
+        pos = structural + 1;
     }
 
-    /* Polynomial is non-constant, so we parse it recursively */
-    return SubstringToNonCoeffPoly(source, from, to);
-}
\ No newline at end of file
+    if (pos < length)
+        StreamNumber(stream, &window[pos], length - pos, stream->consumed + pos);
+
+    /* A number at the end of the window may continue in the next one */
+    if (stream->numberLength > 0 && stream->number != stream->carry)
+        StreamCarry(stream, stream->number, stream->numberLength, 0);
+
+    stream->consumed += length;
+}
+
+void PolyStreamFeed(PolyStream* stream, const char* part, size_t length) {
+    for (size_t from = 0; from < length && stream->state != STREAM_ERROR; from += STREAM_WINDOW)
+        StreamWindow(stream, &part[from], (length - from < STREAM_WINDOW ? length - from : STREAM_WINDOW));
+}
+
+bool PolyStreamFinish(PolyStream* stream, Poly* p, size_t* errorPosition) {
+    if (stream->numberLength > 0 && stream->state != STREAM_ERROR)
+        StreamEndNumber(stream);
+
+    /* The last monomial may close only the outermost sum */
+    if (stream->state == STREAM_MONO && stream->depth == 1) {
+        stream->value = StreamPopFrame(stream);
+        stream->state = STREAM_VALUE;
+    }
+
+    bool correct = (stream->state == STREAM_VALUE && stream->depth == 0);
+
+    if (correct) {
+        *p = stream->value;
+    } else {
+        StreamFail(stream, stream->consumed);
+        PolyDestroy(&stream->value);
+
+        for (size_t frameID = 0; frameID < stream->depth; frameID++) {
+            ParseFrame* frame = &stream->frames[frameID];
+            for (size_t monoID = 0; monoID < frame->size; monoID++)
+                MonoDestroy(&frame->monos[monoID]);
+            free(frame->monos);
+        }
+
+        if (errorPosition)
+            *errorPosition = stream->errorPosition;
+    }
+
+    free(stream->frames);
+    free(stream->carry);
+    PolyIndexDestroy(&stream->index);
+
+    return correct;
+}
+
+bool ParsePoly(const char* source, size_t length, Poly* p, size_t* errorPosition) {
+    PolyStream stream;
+    PolyStreamInitialize(&stream);
+    PolyStreamFeed(&stream, source, length);
+
+    return PolyStreamFinish(&stream, p, errorPosition);
+}
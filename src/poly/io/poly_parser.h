@@ -10,14 +10,85 @@
 #define POLYNOMIALS_POLY_PARSER_H
 
 #include "../poly.h"
+#include "poly_index.h"
+
+/** Monomials of a sum, which is being parsed. */
+typedef struct ParseFrame {
+    Mono*  monos;    ///< parsed monomials
+    size_t size;     ///< number of parsed monomials
+    size_t capacity; ///< number of monomials which fit without reallocation
+} ParseFrame;
+
+/** Places of a streaming parser in the grammar of a polynomial. */
+typedef enum StreamState {
+    STREAM_POLY,      ///< polynomial or its coefficient is expected
+    STREAM_EXP,       ///< exponent is expected
+    STREAM_VALUE,     ///< polynomial has been parsed
+    STREAM_MONO_END,  ///< exponent has been parsed
+    STREAM_MONO,      ///< monomial has been parsed
+    STREAM_NEXT_MONO, ///< plus sign has been parsed
+    STREAM_ERROR      ///< characters were incorrect
+} StreamState;
+
+/**
+ * Type representing a parser, which consumes a line in parts of any size.
+ * Monomials are built as soon as they are closed, so apart from the parsed
+ * polynomial only the sums on the current nesting path and the number
+ * being read are kept.
+ */
+typedef struct PolyStream {
+    StreamState state;         ///< place in the grammar
+    ParseFrame* frames;        ///< sums being parsed, the innermost one on top
+    size_t      depth;         ///< number of sums being parsed
+    size_t      capacity;      ///< number of frames which fit without reallocation
+    Poly        value;         ///< last parsed polynomial
+    poly_exp_t  exp;           ///< last parsed exponent
+    const char* number;        ///< characters of the number being read
+    size_t      numberLength;  ///< number of characters of the number being read
+    size_t      numberStart;   ///< position of the number being read in the line
+    char*       carry;         ///< copy of a number, which continues in the next part
+    size_t      carryCapacity; ///< size of @p carry
+    size_t      consumed;      ///< number of characters consumed
+    size_t      errorPosition; ///< position of the first wrong character
+    PolyIndex   index;         ///< structural index of the current part
+} PolyStream;
+
+/**
+ * Initializes a parser of a new line.
+ * @param[in] stream : parser to initialize
+ */
+void PolyStreamInitialize(PolyStream* stream);
+
+/**
+ * Consumes the next part of a line. Nothing is parsed after an error,
+ * but the remaining parts of the line may still be fed.
+ * @param[in] stream : parser
+ * @param[in] part : characters, which may be released after the call
+ * @param[in] length : number of characters
+ */
+void PolyStreamFeed(PolyStream* stream, const char* part, size_t length);
+
+/**
+ * Ends a line and releases resources of a parser.
+ * @param[in] stream : parser
+ * @param[out] p : parsed polynomial
+ * @param[out] errorPosition : destination for the index of the first wrong
+ * character in case of an error, may be NULL
+ * @return Did the fed characters represent a correct polynomial?
+ */
+bool PolyStreamFinish(PolyStream* stream, Poly* p, size_t* errorPosition);
 
 /**
- * Parses a range [@p from, @p to) of characters from @p source onto polynomial.
+ * Parses @p length characters from @p source onto polynomial. Characters are
+ * classified into a structural index first, and then the polynomial is built
+ * in a single pass, which jumps between structural characters.
  * @param[in] source : word
- * @param[in] from : including start
- * @param[in] to : excluding end
- * @return parsed polynomial
+ * @param[in] length : number of characters
+ * @param[out] p : parsed polynomial
+ * @param[out] errorPosition : destination for the index of the first wrong
+ * character in case of an error, may be NULL
+ * @return Do the characters represent a correct polynomial?
  */
-Poly SubstringToPoly(const char* source, size_t from, size_t to);
+bool ParsePoly(const char* source, size_t length, Poly* p, size_t* errorPosition);
 
 #endif //POLYNOMIALS_POLY_PARSER_H
@@ -10,9 +10,21 @@
 #include <string.h>
 
 #include "poly.h"
+#include "poly_terms.h"
+#include "poly_parallel.h"
+#include "poly_simd.h"
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
+/**
+ * Minimal estimated work of a composed level, i.e. its number of monomials
+ * times the number of monomials of the inner polynomial, which is split between threads.
+ */
+#define COMPOSE_PARALLEL_MIN_WORK 4096
+
+/** Minimal number of pairs of partial results of a composed level, which are added in parallel. */
+#define COMPOSE_PARALLEL_MIN_PAIRS 4
+
 /**
  * Checks whether the monomial is constant
  * @param[in] m : monomial
@@ -94,93 +106,190 @@ static Poly PolyReduce(Poly *p, size_t newSize) {
 }
 
 /**
- * Adds two monomials of a same degree
- * @param[in] m1 : monomial @f$m_1@f$
- * @param[in] m2 : monomial @f$m_2@f$
- * @return @f$m_1 + m_2@f$
+ * Creates a deep copy of a polynomial multiplied by a number.
+ * @param[in] p : polynomial @f$p@f$
+ * @param[in] c : number @f$c@f$
+ * @return @f$c * p@f$
  */
-static inline Mono MonoAdd(const Mono *m1, const Mono *m2) {
-    assert(MonoGetExp(m1) == MonoGetExp(m2));
-    return (Mono) {
-        .exp = MonoGetExp(m1),
-        .p = PolyAdd(MonoGetPoly(m1), MonoGetPoly(m2))
-    };
+static Poly PolyScaledClone(const Poly *p, poly_coeff_t c) {
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(p->coeff * c);
+    else if (c == 1)
+        return PolyClone(p);
+
+    size_t resMonoID = 0;
+    Poly resPoly = PolyAllocate(p->size);
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        Mono midResult = {
+            .exp = MonoGetExp(&p->arr[pMonoID]),
+            .p = PolyScaledClone(MonoGetPoly(&p->arr[pMonoID]), c)
+        };
+
+        if (!MonoIsZero(&midResult))
+            resPoly.arr[resMonoID++] = midResult;
+    }
+
+    return PolyReduce(&resPoly, resMonoID);
 }
 
 /**
- * Adds two non-constant polynomials.
- * @param[in] p : non-constant polynomial @f$p@f$
- * @param[in] q : non-constant polynomial @f$q@f$
- * @return @f$p + q@f$
+ * Returns monomials of a polynomial, viewing a constant polynomial as its free term.
+ * @param[in] p : polynomial @f$p@f$
+ * @param[in] freeTerm : storage for the free term of a constant @p p
+ * @param[out] size : number of returned monomials
+ * @return monomials of @p p
  */
-static Poly PolyAddNoConst(const Poly *p, const Poly *q) {
-    assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
+static const Mono* PolyMonosView(const Poly *p, Mono *freeTerm, size_t *size) {
+    if (!PolyIsCoeff(p)) {
+        *size = p->size;
+        return p->arr;
+    }
 
-    size_t resMonoID = 0, pMonoID = 0, qMonoID = 0;
-    Poly resPoly = PolyAllocate(p->size + q->size);
+    *freeTerm = (Mono) {.exp = 0, .p = *p};
+    *size = 1;
+    return freeTerm;
+}
 
-    while (pMonoID < p->size && qMonoID < q->size) {
-        if (MonoGetExp(&p->arr[pMonoID]) < MonoGetExp(&q->arr[qMonoID])) {
-            resPoly.arr[resMonoID++] = MonoClone(&p->arr[pMonoID++]);
-        } else if (MonoGetExp(&p->arr[pMonoID]) > MonoGetExp(&q->arr[qMonoID])) {
-            resPoly.arr[resMonoID++] = MonoClone(&q->arr[qMonoID++]);
+Poly PolyLinComb(poly_coeff_t a, const Poly *p, poly_coeff_t b, const Poly *q) {
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return PolyFromCoeff(a * p->coeff + b * q->coeff);
+    else if (b == 0 || PolyIsZero(q))
+        return PolyScaledClone(p, a);
+    else if (a == 0 || PolyIsZero(p))
+        return PolyScaledClone(q, b);
+
+    Mono pFreeTerm, qFreeTerm;
+    size_t pSize, qSize;
+    const Mono *pMonos = PolyMonosView(p, &pFreeTerm, &pSize);
+    const Mono *qMonos = PolyMonosView(q, &qFreeTerm, &qSize);
+
+    size_t resMonoID = 0, pMonoID = 0, qMonoID = 0;
+    Poly resPoly = PolyAllocate(pSize + qSize);
+
+    while (pMonoID < pSize || qMonoID < qSize) {
+        Mono midResult;
+
+        if (qMonoID == qSize ||
+            (pMonoID < pSize && MonoGetExp(&pMonos[pMonoID]) < MonoGetExp(&qMonos[qMonoID]))) {
+            midResult.exp = MonoGetExp(&pMonos[pMonoID]);
+            midResult.p = PolyScaledClone(MonoGetPoly(&pMonos[pMonoID++]), a);
+        } else if (pMonoID == pSize || MonoGetExp(&pMonos[pMonoID]) > MonoGetExp(&qMonos[qMonoID])) {
+            midResult.exp = MonoGetExp(&qMonos[qMonoID]);
+            midResult.p = PolyScaledClone(MonoGetPoly(&qMonos[qMonoID++]), b);
         } else {
-            Mono midResult = MonoAdd(&p->arr[pMonoID++], &q->arr[qMonoID++]);
-            if (!MonoIsZero(&midResult))
-                resPoly.arr[resMonoID++] = midResult;
+            midResult.exp = MonoGetExp(&pMonos[pMonoID]);
+            midResult.p = PolyLinComb(a, MonoGetPoly(&pMonos[pMonoID++]),
+                                      b, MonoGetPoly(&qMonos[qMonoID++]));
         }
-    }
 
-    while (pMonoID < p->size)
-        resPoly.arr[resMonoID++] = MonoClone(&p->arr[pMonoID++]);
-    while (qMonoID < q->size)
-        resPoly.arr[resMonoID++] = MonoClone(&q->arr[qMonoID++]);
+        if (!MonoIsZero(&midResult))
+            resPoly.arr[resMonoID++] = midResult;
+    }
 
     return PolyReduce(&resPoly, resMonoID);
 }
 
+Poly PolyAdd(const Poly *p, const Poly *q) {
+    return PolyLinComb(1, p, 1, q);
+}
+
 /**
- * Adds constant polynomial @p p to a non-constant polynomial @p q.
- * @param[in] p : constant polynomial @f$p@f$
- * @param[in] q : non-constant polynomial @f$q@f$
- * @return @f$p + q@f$
+ * Finds the first monomial of a sorted array, whose exponent is not lower than @p exp.
+ * @param[in] monos : monomials sorted by exponents
+ * @param[in] count : number of monomials
+ * @param[in] exp : exponent
+ * @return index of the monomial or @p count if there is none
  */
-static Poly PolyAddOneConst(const Poly* p, const Poly* q) {
-    assert(PolyIsCoeff(p) && !PolyIsCoeff(q));
-
-    size_t resMonoID = 0, qMonoID = 0;
-    Mono constTermMono = MonoFromPoly(p, 0);
-    Poly resPoly = PolyAllocate(q->size + 1);
-    Mono newFreeTerm = MonoGetExp(&q->arr[qMonoID]) == 0 ?
-                       MonoAdd(&constTermMono, &q->arr[qMonoID++]) :
-                       constTermMono;
-
-    if (!MonoIsZero(&newFreeTerm))
-        resPoly.arr[resMonoID++] = newFreeTerm;
-
-    while (qMonoID < q->size)
-        resPoly.arr[resMonoID++] = MonoClone(&q->arr[qMonoID++]);
+static size_t MonosLowerBound(const Mono monos[], size_t count, poly_exp_t exp) {
+    size_t lower = 0, upper = count;
+
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (MonoGetExp(&monos[middle]) < exp)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
 
-    return PolyReduce(&resPoly, resMonoID);
+    return lower;
 }
 
 /**
- * Adds two constant polynomials.
- * @param[in] p : constant polynomial @f$p@f$
- * @param[in] q : constant polynomial @f$q@f$
- * @return @f$p + q@f$
+ * Checks whether a sorted array of monomials contains an exponent.
+ * @param[in] monos : monomials sorted by exponents
+ * @param[in] count : number of monomials
+ * @param[in] exp : exponent
+ * @return Is there a monomial of exponent @p exp?
  */
-static Poly PolyAddBothConst(const Poly *p, const Poly *q) {
-    assert(PolyIsCoeff(p) && PolyIsCoeff(q));
-    return PolyFromCoeff(p->coeff + q->coeff);
+static bool MonosHaveExp(const Mono monos[], size_t count, poly_exp_t exp) {
+    size_t lower = MonosLowerBound(monos, count, exp);
+    return lower < count && MonoGetExp(&monos[lower]) == exp;
 }
 
-Poly PolyAdd(const Poly *p, const Poly *q) {
-    if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return PolyAddBothConst(p, q);
-    else if (!PolyIsCoeff(p) && !PolyIsCoeff(q))
-        return PolyAddNoConst(p, q);
-    return (PolyIsCoeff(p) ? PolyAddOneConst(p, q) : PolyAddOneConst(q, p));
+void PolyAddScaledInPlace(Poly *p, poly_coeff_t c, const Poly *q) {
+    if (c == 0 || PolyIsZero(q)) {
+        return;
+    } else if (PolyIsCoeff(p)) {
+        *p = PolyLinComb(1, p, c, q);
+        return;
+    }
+
+    Mono qFreeTerm;
+    size_t qSize;
+    const Mono *qMonos = PolyMonosView(q, &qFreeTerm, &qSize);
+
+    size_t matches = 0;
+    for (size_t qMonoID = 0; qMonoID < qSize; qMonoID++)
+        matches += MonosHaveExp(p->arr, p->size, MonoGetExp(&qMonos[qMonoID]));
+
+    size_t newSize = p->size + qSize - matches;
+    if (newSize > p->size) {
+        p->arr = realloc(p->arr, newSize * sizeof(Mono));
+        CHECK_NULL_PTR(p->arr);
+    }
+
+    /*
+     * Merging goes from the back. Monomials of p between consecutive exponents
+     * of q are moved as a block, and only if new monomials above them shift them.
+     */
+    size_t pMonoID = p->size, qMonoID = qSize, resMonoID = newSize;
+
+    while (qMonoID > 0) {
+        const Mono *qMono = &qMonos[--qMonoID];
+        size_t lower = MonosLowerBound(p->arr, pMonoID, MonoGetExp(qMono));
+        bool hasExp = lower < pMonoID && MonoGetExp(&p->arr[lower]) == MonoGetExp(qMono);
+        size_t blockStart = lower + (hasExp ? 1 : 0);
+        size_t blockLength = pMonoID - blockStart;
+
+        resMonoID -= blockLength;
+        if (resMonoID != blockStart)
+            memmove(&p->arr[resMonoID], &p->arr[blockStart], blockLength * sizeof(Mono));
+        pMonoID = blockStart;
+
+        Mono midResult;
+
+        if (hasExp) {
+            midResult = p->arr[--pMonoID];
+            PolyAddScaledInPlace(&midResult.p, c, MonoGetPoly(qMono));
+        } else {
+            midResult.exp = MonoGetExp(qMono);
+            midResult.p = PolyScaledClone(MonoGetPoly(qMono), c);
+        }
+
+        /* A cancelled monomial leaves a gap below the merged ones */
+        if (MonoIsZero(&midResult))
+            MonoDestroy(&midResult);
+        else
+            p->arr[--resMonoID] = midResult;
+    }
+
+    if (resMonoID > pMonoID) {
+        memmove(&p->arr[pMonoID], &p->arr[resMonoID], (newSize - resMonoID) * sizeof(Mono));
+        newSize -= resMonoID - pMonoID;
+    }
+
+    *p = PolyReduce(p, newSize);
 }
 
 /**
@@ -189,12 +298,9 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
  * @param[in] q : polynomial to add @f$q@f$
  */
 static void PolyAddTo(Poly *p, const Poly *q) {
-    Poly midResult = PolyAdd(p, q);
-    PolyDestroy(p);
-    *p = midResult;
+    PolyAddScaledInPlace(p, 1, q);
 }
 
-
 /**
  * Multiples polynomial @f$q@f$ by polynomial @f$p@f$ and performs left-side assignment.
  * @param[in] p : polynomial to update @f$p@f$
@@ -212,24 +318,25 @@ static void PolyMulBy(Poly *p, const Poly *q) {
  * @param[in] m2 : monomial to add @f$q@f$
  */
 static void MonoAddTo(Mono *m1, const Mono *m2) {
-    Mono midResult = MonoAdd(m1, m2);
-    MonoDestroy(m1);
-    *m1 = midResult;
+    assert(MonoGetExp(m1) == MonoGetExp(m2));
+    PolyAddTo(&m1->p, MonoGetPoly(m2));
 }
 
 /**
  * Comparator for sorting monomials by exponents in ascending order.
  * @param[in] m1 : monomial @f$m_1@f$
  * @param[in] m2 : monomial @f$m_2@f$
- * @return difference of exponents
+ * @return sign of the difference of exponents
  */
 static inline int MonoComparator(const void* m1, const void* m2) {
-     return MonoGetExp(m1) - MonoGetExp(m2);
+     return (MonoGetExp(m1) > MonoGetExp(m2)) - (MonoGetExp(m1) < MonoGetExp(m2));
 }
 
 Poly PolyOwnMonos(size_t count, Mono *monos) {
-    if (count == 0 || !monos)
+    if (count == 0 || !monos) {
+        free(monos);
         return PolyZero();
+    }
 
     size_t resMonoID = 0;
     Poly resPoly = PolyAllocate(count);
@@ -288,6 +395,195 @@ static inline Mono MonoMul(const Mono *m1, const Mono *m2) {
     };
 }
 
+/**
+ * Checks whether all monomials of a non-constant polynomial have constant coefficients.
+ * @param[in] p : non-constant polynomial
+ * @return Are all coefficients constant?
+ */
+static bool PolyHasConstCoeffs(const Poly *p) {
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        if (!MonoHasConstPoly(&p->arr[pMonoID]))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Computes the greatest common divisor of two exponents.
+ * @param[in] a : exponent @f$a@f$
+ * @param[in] b : exponent @f$b@f$
+ * @return @f$gcd(a, b)@f$, where @f$gcd(0, 0) = 0@f$
+ */
+static poly_exp_t ExpGcd(poly_exp_t a, poly_exp_t b) {
+    while (b != 0) {
+        poly_exp_t rest = a % b;
+        a = b;
+        b = rest;
+    }
+
+    return a;
+}
+
+/**
+ * Computes the greatest common divisor of distances between
+ * the lowest exponent of a non-constant polynomial and the others.
+ * @param[in] p : non-constant polynomial
+ * @return exponent step of @p p, zero for a single monomial
+ */
+static poly_exp_t PolyExpStep(const Poly *p) {
+    poly_exp_t lowestExp = MonoGetExp(&p->arr[0]), step = 0;
+
+    for (size_t pMonoID = 1; pMonoID < p->size && step != 1; pMonoID++)
+        step = ExpGcd(MonoGetExp(&p->arr[pMonoID]) - lowestExp, step);
+
+    return step;
+}
+
+/**
+ * Maps exponent @f$e@f$ of a monomial of @p p onto @f$(e - e_{min}) / step@f$.
+ * @param[in] p : non-constant polynomial
+ * @param[in] pMonoID : index of a monomial
+ * @param[in] step : divisor of the exponent step of @p p
+ * @return deflated exponent
+ */
+static inline size_t PolyDeflatedExp(const Poly *p, size_t pMonoID, poly_exp_t step) {
+    return (size_t) ((MonoGetExp(&p->arr[pMonoID]) - MonoGetExp(&p->arr[0])) / step);
+}
+
+/**
+ * Creates a view of a non-constant polynomial @f$x^{shift} r(x^{step})@f$ as @f$r(x)@f$.
+ * The view shares coefficients with @p p, so only its array should be freed.
+ * @param[in] p : non-constant polynomial
+ * @param[in] step : divisor of the exponent step of @p p
+ * @return deflated view of @p p
+ */
+static Poly PolyDeflatedView(const Poly *p, poly_exp_t step) {
+    Poly view = PolyAllocate(p->size);
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        view.arr[pMonoID].p = p->arr[pMonoID].p;
+        view.arr[pMonoID].exp = (poly_exp_t) PolyDeflatedExp(p, pMonoID, step);
+    }
+
+    return view;
+}
+
+/**
+ * Maps polynomial @f$r(x)@f$ onto @f$x^{shift} r(x^{step})@f$ in place.
+ * @param[in] p : polynomial to inflate
+ * @param[in] shift : exponent of the monomial content
+ * @param[in] step : exponent step
+ * @return inflated polynomial
+ */
+static Poly PolyInflate(Poly *p, poly_exp_t shift, poly_exp_t step) {
+    if (PolyIsCoeff(p)) {
+        if (shift == 0 || PolyIsZero(p))
+            return *p;
+
+        Poly resPoly = PolyAllocate(1);
+        resPoly.arr[0] = MonoFromPoly(p, shift);
+        return resPoly;
+    }
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++)
+        p->arr[pMonoID].exp = p->arr[pMonoID].exp * step + shift;
+
+    return *p;
+}
+
+/**
+ * Multiples non-constant polynomials with constant coefficients using an array
+ * indexed by deflated exponents of the product instead of sorting the products.
+ * @param[in] p : non-constant polynomial @f$p@f$
+ * @param[in] q : non-constant polynomial @f$q@f$
+ * @param[in] step : common divisor of the exponent steps of @p p and @p q
+ * @param[in] length : deflated exponent range of the product
+ * @return @f$p * q@f$
+ */
+static Poly PolyMulDense(const Poly *p, const Poly *q, poly_exp_t step, size_t length) {
+    poly_coeff_t* productCoeffs = calloc(length, sizeof(poly_coeff_t));
+    size_t* qDeflatedExps = malloc(q->size * sizeof(size_t));
+    CHECK_NULL_PTR(productCoeffs);
+    CHECK_NULL_PTR(qDeflatedExps);
+
+    for (size_t qMonoID = 0; qMonoID < q->size; qMonoID++)
+        qDeflatedExps[qMonoID] = PolyDeflatedExp(q, qMonoID, step);
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        poly_coeff_t pCoeff = MonoGetPoly(&p->arr[pMonoID])->coeff;
+        poly_coeff_t* shiftedCoeffs = &productCoeffs[PolyDeflatedExp(p, pMonoID, step)];
+
+        for (size_t qMonoID = 0; qMonoID < q->size; qMonoID++)
+            shiftedCoeffs[qDeflatedExps[qMonoID]] += pCoeff * MonoGetPoly(&q->arr[qMonoID])->coeff;
+    }
+
+    size_t resMonoID = 0;
+    poly_exp_t shift = MonoGetExp(&p->arr[0]) + MonoGetExp(&q->arr[0]);
+    Poly resPoly = PolyAllocate(p->size * q->size < length ? p->size * q->size : length);
+
+    for (size_t deflatedExp = 0; deflatedExp < length; deflatedExp++) {
+        if (productCoeffs[deflatedExp] != 0) {
+            Poly coeffPoly = PolyFromCoeff(productCoeffs[deflatedExp]);
+            resPoly.arr[resMonoID++] = MonoFromPoly(&coeffPoly, (poly_exp_t) deflatedExp * step + shift);
+        }
+    }
+
+    free(productCoeffs);
+    free(qDeflatedExps);
+
+    return PolyReduce(&resPoly, resMonoID);
+}
+
+/**
+ * Multiples non-constant polynomials using an array of polynomials indexed by
+ * deflated exponents of the product. Products of coefficients are computed
+ * by PolyMul, which deflates the exponents of the next variable in turn.
+ * @param[in] p : non-constant polynomial @f$p@f$
+ * @param[in] q : non-constant polynomial @f$q@f$
+ * @param[in] step : common divisor of the exponent steps of @p p and @p q
+ * @param[in] length : deflated exponent range of the product
+ * @return @f$p * q@f$
+ */
+static Poly PolyMulDenseNested(const Poly *p, const Poly *q, poly_exp_t step, size_t length) {
+    Poly* productPolys = malloc(length * sizeof(Poly));
+    CHECK_NULL_PTR(productPolys);
+
+    for (size_t deflatedExp = 0; deflatedExp < length; deflatedExp++)
+        productPolys[deflatedExp] = PolyZero();
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        Poly* shiftedPolys = &productPolys[PolyDeflatedExp(p, pMonoID, step)];
+
+        for (size_t qMonoID = 0; qMonoID < q->size; qMonoID++) {
+            Poly* productPoly = &shiftedPolys[PolyDeflatedExp(q, qMonoID, step)];
+            Poly midResult = PolyMul(MonoGetPoly(&p->arr[pMonoID]), MonoGetPoly(&q->arr[qMonoID]));
+
+            if (PolyIsZero(productPoly)) {
+                *productPoly = midResult;
+            } else {
+                PolyAddScaledInPlace(productPoly, 1, &midResult);
+                PolyDestroy(&midResult);
+            }
+        }
+    }
+
+    size_t resMonoID = 0;
+    poly_exp_t shift = MonoGetExp(&p->arr[0]) + MonoGetExp(&q->arr[0]);
+    Poly resPoly = PolyAllocate(length);
+
+    for (size_t deflatedExp = 0; deflatedExp < length; deflatedExp++) {
+        if (!PolyIsZero(&productPolys[deflatedExp])) {
+            resPoly.arr[resMonoID++] = MonoFromPoly(&productPolys[deflatedExp],
+                                                    (poly_exp_t) deflatedExp * step + shift);
+        }
+    }
+
+    free(productPolys);
+
+    return PolyReduce(&resPoly, resMonoID);
+}
+
 /**
  * Multiples non-constant monomials
  * @param[in] p : non-constant monomial @f$p@f$
@@ -297,6 +593,21 @@ static inline Mono MonoMul(const Mono *m1, const Mono *m2) {
 static Poly PolyMulNoConst(const Poly *p, const Poly *q) {
     assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
 
+    /*
+     * Dense products of deflated polynomials are accumulated without sorting.
+     * Coefficients are multiplied by PolyMul, so every variable is deflated.
+     */
+    poly_exp_t step = ExpGcd(PolyExpStep(p), PolyExpStep(q));
+    step = (step == 0 ? 1 : step);
+
+    size_t length = PolyDeflatedExp(p, p->size - 1, step) +
+                    PolyDeflatedExp(q, q->size - 1, step) + 1;
+
+    if (length <= p->size * q->size) {
+        return (PolyHasConstCoeffs(p) && PolyHasConstCoeffs(q) ?
+                PolyMulDense(p, q, step, length) : PolyMulDenseNested(p, q, step, length));
+    }
+
     size_t resMonoID = 0;
     Poly resPoly = PolyAllocate(p->size * q->size);
 
@@ -308,8 +619,8 @@ static Poly PolyMulNoConst(const Poly *p, const Poly *q) {
         }
     }
 
-    PolyReduce(&resPoly, resMonoID);
-    Poly resPolySorted = PolyAddMonos(resPoly.size, resPoly.arr);
+    /* Products are summed up as they are, even if they all overflowed to zero */
+    Poly resPolySorted = PolyAddMonos(resMonoID, resPoly.arr);
     free(resPoly.arr);
 
     return resPolySorted;
@@ -323,21 +634,7 @@ static Poly PolyMulNoConst(const Poly *p, const Poly *q) {
  */
 static Poly PolyMulOneConst(const Poly *p, const Poly *q) {
     assert(PolyIsCoeff(p) && !PolyIsCoeff(q));
-
-    if (PolyIsZero(p))
-        return PolyZero();
-
-    size_t resMonoID = 0;
-    Poly resPoly = PolyAllocate(q->size);
-    Mono constTermMono = MonoFromPoly(p, 0);
-
-    for (size_t qMonoID = 0; qMonoID < q->size; qMonoID++) {
-        Mono midResult = MonoMul(&constTermMono, &q->arr[qMonoID]);
-        if (!MonoIsZero(&midResult))
-            resPoly.arr[resMonoID++] = midResult;
-    }
-
-    return PolyReduce(&resPoly, resMonoID);
+    return PolyScaledClone(q, p->coeff);
 }
 
 /**
@@ -360,17 +657,70 @@ Poly PolyMul(const Poly *p, const Poly *q) {
 }
 
 Poly PolyNeg(const Poly *p) {
-    const Poly minusOne = PolyFromCoeff(-1);
-    return PolyMul(p, &minusOne);
+    return PolyLinComb(-1, p, 0, p);
 }
 
 Poly PolySub(const Poly *p, const Poly *q) {
-    Poly qNegated = PolyNeg(q);
-    Poly resPoly = PolyAdd(p, &qNegated);
+    return PolyLinComb(1, p, -1, q);
+}
 
-    PolyDestroy(&qNegated);
+/**
+ * Multiplies constant coefficients of monomials by a number.
+ * @param[in] monos : monomials with constant coefficients
+ * @param[in] count : number of monomials
+ * @param[in] c : number @f$c@f$
+ * @return number of coefficients which became zero
+ */
+POLY_SIMD_CLONES
+static size_t MonosScaleCoeffs(Mono *monos, size_t count, poly_coeff_t c) {
+    size_t zeros = 0;
 
-    return resPoly;
+    for (size_t monoID = 0; monoID < count; monoID++) {
+        monos[monoID].p.coeff *= c;
+        zeros += (monos[monoID].p.coeff == 0);
+    }
+
+    return zeros;
+}
+
+void PolyScaleInPlace(Poly *p, poly_coeff_t c) {
+    if (PolyIsCoeff(p)) {
+        p->coeff *= c;
+        return;
+    } else if (c == 0) {
+        PolyDestroy(p);
+        *p = PolyZero();
+        return;
+    } else if (c == 1) {
+        return;
+    }
+
+    size_t zeros = 0;
+
+    if (PolyHasConstCoeffs(p)) {
+        zeros = MonosScaleCoeffs(p->arr, p->size, c);
+    } else {
+        for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+            PolyScaleInPlace(&p->arr[pMonoID].p, c);
+            zeros += PolyIsZero(MonoGetPoly(&p->arr[pMonoID]));
+        }
+    }
+
+    /* Coefficients may vanish only when overflowing, so pruning is rare */
+    if (zeros == 0)
+        return;
+
+    size_t resMonoID = 0;
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        if (!MonoIsZero(&p->arr[pMonoID]))
+            p->arr[resMonoID++] = p->arr[pMonoID];
+    }
+
+    *p = PolyReduce(p, resMonoID);
+}
+
+void PolyNegInPlace(Poly *p) {
+    PolyScaleInPlace(p, -1);
 }
 
 /**
@@ -387,25 +737,179 @@ static poly_coeff_t NumberToPower(poly_coeff_t base, poly_exp_t exp) {
     return sqrtResult * sqrtResult * (exp % 2 == 1 ? base : 1);
 }
 
+/** Coefficient of a monomial of one of summed polynomials, with its scale. */
+typedef struct ScaledTerm {
+    poly_exp_t   exp;   ///< exponent of the monomial
+    poly_coeff_t scale; ///< number multiplying the coefficient
+    const Poly  *p;     ///< coefficient of the monomial
+} ScaledTerm;
+
+/**
+ * Comparator for sorting scaled terms by exponents in ascending order.
+ * @param[in] t1 : term @f$t_1@f$
+ * @param[in] t2 : term @f$t_2@f$
+ * @return sign of the difference of exponents
+ */
+static int ScaledTermComparator(const void *t1, const void *t2) {
+    poly_exp_t exp1 = ((const ScaledTerm*) t1)->exp, exp2 = ((const ScaledTerm*) t2)->exp;
+    return (exp1 > exp2) - (exp1 < exp2);
+}
+
+/**
+ * Sums up coefficients of a group of terms with the same exponent.
+ * @param[in] count : number of terms
+ * @param[in] terms : terms
+ * @return sum of scaled coefficients
+ */
+static Poly ScaledTermsSum(size_t count, const ScaledTerm terms[]) {
+    if (count == 1)
+        return PolyScaledClone(terms[0].p, terms[0].scale);
+
+    poly_coeff_t* scales = malloc(count * sizeof(poly_coeff_t));
+    const Poly** polys = malloc(count * sizeof(Poly*));
+    CHECK_NULL_PTR(scales);
+    CHECK_NULL_PTR(polys);
+
+    for (size_t termID = 0; termID < count; termID++) {
+        scales[termID] = terms[termID].scale;
+        polys[termID] = terms[termID].p;
+    }
+
+    Poly resPoly = PolySumScaled(count, scales, polys);
+
+    free(scales);
+    free(polys);
+
+    return resPoly;
+}
+
+Poly PolySumScaled(size_t count, const poly_coeff_t scales[], const Poly *const polys[]) {
+    size_t termCount = 0;
+    poly_coeff_t constSum = 0;
+    bool allCoeffs = true;
+
+    for (size_t polyID = 0; polyID < count; polyID++) {
+        if (PolyIsCoeff(polys[polyID]))
+            constSum += scales[polyID] * polys[polyID]->coeff;
+        else
+            allCoeffs = false;
+        termCount += (PolyIsCoeff(polys[polyID]) ? 1 : polys[polyID]->size);
+    }
+
+    if (allCoeffs)
+        return PolyFromCoeff(constSum);
+    else if (count == 1)
+        return PolyScaledClone(polys[0], scales[0]);
+
+    /* Constants are free terms, and monomials of all polynomials are merged by exponents */
+    size_t termID = 0;
+    ScaledTerm* terms = malloc(termCount * sizeof(ScaledTerm));
+    CHECK_NULL_PTR(terms);
+
+    for (size_t polyID = 0; polyID < count; polyID++) {
+        const Poly *p = polys[polyID];
+
+        if (PolyIsCoeff(p)) {
+            terms[termID++] = (ScaledTerm) {.exp = 0, .scale = scales[polyID], .p = p};
+            continue;
+        }
+
+        for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+            terms[termID++] = (ScaledTerm) {
+                .exp = MonoGetExp(&p->arr[pMonoID]),
+                .scale = scales[polyID],
+                .p = MonoGetPoly(&p->arr[pMonoID])
+            };
+        }
+    }
+
+    qsort(terms, termCount, sizeof(ScaledTerm), ScaledTermComparator);
+
+    size_t resMonoID = 0;
+    Poly resPoly = PolyAllocate(termCount);
+
+    for (size_t from = 0, to; from < termCount; from = to) {
+        for (to = from + 1; to < termCount && terms[to].exp == terms[from].exp; to++);
+
+        Mono midResult = {.exp = terms[from].exp, .p = ScaledTermsSum(to - from, &terms[from])};
+        if (!MonoIsZero(&midResult))
+            resPoly.arr[resMonoID++] = midResult;
+    }
+
+    free(terms);
+
+    return PolyReduce(&resPoly, resMonoID);
+}
+
+/**
+ * Computes @f$x^{exp}@f$ from @f$x^{lowerExp}@f$.
+ * @param[in] power : @f$x^{lowerExp}@f$
+ * @param[in] x : @f$x@f$
+ * @param[in] lowerExp : exponent of @p power
+ * @param[in] exp : exponent not less than @p lowerExp
+ * @return @f$x^{exp}@f$
+ */
+static poly_coeff_t NumberNextPower(poly_coeff_t power, poly_coeff_t x, poly_exp_t lowerExp, poly_exp_t exp) {
+    if (x == 1)
+        return 1;
+    else if (x == -1)
+        return (exp % 2 == 0 ? 1 : -1);
+    return power * NumberToPower(x, exp - lowerExp);
+}
+
 Poly PolyAt(const Poly *p, poly_coeff_t x) {
     if (PolyIsCoeff(p))
         return PolyClone(p);
 
-    Poly resPoly = PolyZero();
+    /* Only the free term survives substituting zero */
+    if (x == 0) {
+        return MonoGetExp(&p->arr[0]) == 0 ?
+               PolyClone(MonoGetPoly(&p->arr[0])) : PolyZero();
+    }
+
+    size_t count = 0;
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        const Poly *coeffPoly = MonoGetPoly(&p->arr[pMonoID]);
+        count += (PolyIsCoeff(coeffPoly) ? 1 : coeffPoly->size);
+    }
+
+    /* Scaled monomials of all coefficients are gathered and merged at once */
+    size_t resMonoID = 0;
+    Mono* monos = malloc(count * sizeof(Mono));
+    CHECK_NULL_PTR(monos);
+
+    poly_coeff_t power = 1;
+    poly_exp_t lowerExp = 0;
 
     for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
-        poly_exp_t curExp = MonoGetExp(&p->arr[pMonoID]);
-        poly_coeff_t newCoeff = NumberToPower(x, curExp);
-        Poly coeffPoly = PolyFromCoeff(newCoeff);
-        Poly midResult = PolyMul(MonoGetPoly(&p->arr[pMonoID]), &coeffPoly);
+        const Poly *coeffPoly = MonoGetPoly(&p->arr[pMonoID]);
+
+        power = NumberNextPower(power, x, lowerExp, MonoGetExp(&p->arr[pMonoID]));
+        lowerExp = MonoGetExp(&p->arr[pMonoID]);
 
-        if (!PolyIsZero(&midResult))
-            PolyAddTo(&resPoly, &midResult);
+        /* All greater powers overflowed to zero as well */
+        if (power == 0)
+            break;
 
-        PolyDestroy(&midResult);
+        if (PolyIsCoeff(coeffPoly)) {
+            monos[resMonoID++] = (Mono) {.exp = 0, .p = PolyFromCoeff(coeffPoly->coeff * power)};
+            continue;
+        }
+
+        for (size_t coeffMonoID = 0; coeffMonoID < coeffPoly->size; coeffMonoID++) {
+            monos[resMonoID++] = (Mono) {
+                .exp = MonoGetExp(&coeffPoly->arr[coeffMonoID]),
+                .p = PolyScaledClone(MonoGetPoly(&coeffPoly->arr[coeffMonoID]), power)
+            };
+        }
     }
 
-    return resPoly;
+    if (resMonoID == 0) {
+        free(monos);
+        return PolyZero();
+    }
+
+    return PolyOwnMonos(resMonoID, monos);
 }
 
 static inline poly_exp_t MonoDegBy(const Mono *m, size_t var_idx) {
@@ -475,18 +979,18 @@ bool PolyIsEq(const Poly *p, const Poly *q) {
 }
 
 /**
- * Raises polynomial @p p to the power @p exp.
+ * Raises polynomial @p p to the power @p exp by repeated squaring.
  * @param[in] p : polynomial @f$p@f$
  * @param[in] exp : exponent
  * @return @f$p^exp@f$
  */
-static Poly PolyToPower(const Poly *p, poly_exp_t exp) {
+static Poly PolyToPowerBySquaring(const Poly *p, poly_exp_t exp) {
     if (exp == 0)
         return PolyFromCoeff(1);
     else if (PolyIsCoeff(p))
         return PolyFromCoeff(NumberToPower(p->coeff, exp));
 
-    Poly sqrtResult = PolyToPower(p, exp / 2);
+    Poly sqrtResult = PolyToPowerBySquaring(p, exp / 2);
     Poly resPoly = PolyMul(&sqrtResult, &sqrtResult);
 
     if (exp % 2 == 1)
@@ -497,40 +1001,475 @@ static Poly PolyToPower(const Poly *p, poly_exp_t exp) {
     return resPoly;
 }
 
-static Poly PolyComposeFrom(const Poly *p, size_t idx, size_t k, const Poly q[]);
+/**
+ * Raises polynomial @p p to the power @p exp. The monomial content
+ * and the exponent step of @p p are factored out before squaring.
+ * @param[in] p : polynomial @f$p@f$
+ * @param[in] exp : exponent
+ * @return @f$p^exp@f$
+ */
+static Poly PolyToPower(const Poly *p, poly_exp_t exp) {
+    if (exp == 0 || PolyIsCoeff(p))
+        return PolyToPowerBySquaring(p, exp);
+
+    poly_exp_t shift = MonoGetExp(&p->arr[0]), step = PolyExpStep(p);
+    step = (step == 0 ? 1 : step);
+
+    if (shift == 0 && step == 1)
+        return PolyToPowerBySquaring(p, exp);
+
+    /* p = x^shift * r(x^step), so p^exp = x^(shift * exp) * r^exp(x^step) */
+    Poly deflated = PolyDeflatedView(p, step);
+    Poly resPoly = PolyToPowerBySquaring(&deflated, exp);
+    free(deflated.arr);
+
+    return PolyInflate(&resPoly, shift * exp, step);
+}
+
+/** Shapes of inner polynomials of a composition with dedicated algorithms. */
+typedef enum ComposeShape {
+    SHAPE_CONST,  ///< constant poly
+    SHAPE_VAR,    ///< single variable @f$x_j@f$
+    SHAPE_MONO,   ///< single monomial @f$c x_0^{n_0} x_1^{n_1} \ldots@f$
+    SHAPE_GENERAL ///< any other poly
+} ComposeShape;
+
+/** Arguments of a composition shared by all its levels. */
+typedef struct ComposeContext {
+    size_t        k;      ///< number of inner polynomials
+    const Poly   *q;      ///< inner polynomials
+    ComposeShape *shapes; ///< shapes of inner polynomials for levels of the outer poly
+    size_t       *vars;   ///< indexes of variables of inner polynomials of SHAPE_VAR
+    bool          parallel; ///< Can monomials of a level be composed in parallel?
+} ComposeContext;
+
+/**
+ * Classifies the shape of an inner polynomial of a composition.
+ * @param[in] q : inner polynomial
+ * @param[in] var : destination for the index of a variable of SHAPE_VAR
+ * @return shape of @p q
+ */
+static ComposeShape PolyComposeShape(const Poly *q, size_t *var) {
+    if (PolyIsCoeff(q))
+        return SHAPE_CONST;
+
+    size_t level = 0, nonZeroExps = 0;
+    poly_exp_t lastNonZeroExp = 0;
+
+    for (; !PolyIsCoeff(q); q = MonoGetPoly(&q->arr[0]), level++) {
+        if (q->size != 1)
+            return SHAPE_GENERAL;
+
+        if (MonoGetExp(&q->arr[0]) != 0) {
+            nonZeroExps++;
+            lastNonZeroExp = MonoGetExp(&q->arr[0]);
+            *var = level;
+        }
+    }
+
+    return (nonZeroExps == 1 && lastNonZeroExp == 1 && q->coeff == 1 ? SHAPE_VAR : SHAPE_MONO);
+}
+
+/**
+ * Raises a single-monomial polynomial @p m to the power @p exp
+ * by multiplying its exponents and raising its coefficient.
+ * @param[in] m : constant or single-monomial polynomial
+ * @param[in] exp : exponent
+ * @return @f$m^exp@f$
+ */
+static Poly PolyMonoToPower(const Poly *m, poly_exp_t exp) {
+    if (exp == 0)
+        return PolyFromCoeff(1);
+    else if (PolyIsCoeff(m))
+        return PolyFromCoeff(NumberToPower(m->coeff, exp));
+
+    Poly coeffPower = PolyMonoToPower(MonoGetPoly(&m->arr[0]), exp);
+    if (PolyIsZero(&coeffPower))
+        return coeffPower;
+
+    Poly resPoly = PolyAllocate(1);
+    resPoly.arr[0] = MonoFromPoly(&coeffPower, MonoGetExp(&m->arr[0]) * exp);
+
+    return PolyReduce(&resPoly, 1);
+}
+
+/**
+ * Multiplies polynomial @p p by a single-monomial polynomial @p m
+ * by shifting exponents and scaling coefficients of @p p.
+ * @param[in] p : polynomial @f$p@f$
+ * @param[in] m : constant or single-monomial polynomial @f$m@f$
+ * @return @f$p * m@f$
+ */
+static Poly PolyMulByMono(const Poly *p, const Poly *m) {
+    if (PolyIsCoeff(p) || PolyIsCoeff(m))
+        return PolyMul(p, m);
+
+    size_t resMonoID = 0;
+    Poly resPoly = PolyAllocate(p->size);
+    poly_exp_t mExp = MonoGetExp(&m->arr[0]);
+
+    for (size_t pMonoID = 0; pMonoID < p->size; pMonoID++) {
+        Poly coeffProduct = PolyMulByMono(MonoGetPoly(&p->arr[pMonoID]), MonoGetPoly(&m->arr[0]));
+
+        if (!PolyIsZero(&coeffProduct))
+            resPoly.arr[resMonoID++] = MonoFromPoly(&coeffProduct, MonoGetExp(&p->arr[pMonoID]) + mExp);
+    }
+
+    return PolyReduce(&resPoly, resMonoID);
+}
+
+static Poly PolyComposeFrom(const Poly *p, size_t idx, const ComposeContext *ctx);
+
+/**
+ * See PolyComposeFrom. Composes monomial @p mono with a single-monomial
+ * @p m at index @p idx, which only rewrites exponents and coefficients.
+ */
+static Poly MonoComposeMonoFrom(const Mono *mono, const Poly *m, size_t idx, const ComposeContext *ctx) {
+    Poly power = PolyMonoToPower(m, MonoGetExp(mono));
+    Poly composition = PolyComposeFrom(MonoGetPoly(mono), idx + 1, ctx);
+    Poly resPoly = PolyMulByMono(&composition, &power);
+
+    PolyDestroy(&power);
+    PolyDestroy(&composition);
+
+    return resPoly;
+}
+
+/** Shared state of a level of a composition split between threads. */
+typedef struct ComposeLevelTask {
+    const Poly           *p;        ///< composed polynomial
+    size_t                idx;      ///< index of the inner polynomial of the level
+    const ComposeContext *ctx;      ///< composition with parallelism disabled
+    const Poly           *squares;  ///< inner polynomial raised to consecutive powers of two
+    Poly                 *partials; ///< compositions of single monomials, then their sums
+    size_t                stride;   ///< distance between summed partial results
+} ComposeLevelTask;
+
+/**
+ * Raises a polynomial to the power @p exp by multiplying its
+ * precomputed squares corresponding to set bits of @p exp.
+ * @param[in] squares : @f$q^{2^0}, q^{2^1}, \ldots@f$
+ * @param[in] exp : exponent
+ * @return @f$q^exp@f$
+ */
+static Poly PolyPowerFromSquares(const Poly squares[], poly_exp_t exp) {
+    Poly resPoly = PolyFromCoeff(1);
+
+    for (size_t bit = 0; exp != 0; bit++, exp /= 2) {
+        if (exp % 2 == 1)
+            PolyMulBy(&resPoly, &squares[bit]);
+    }
+
+    return resPoly;
+}
+
+/**
+ * Composes a single monomial of a level split between threads.
+ * @param[in] monoID : index of the monomial
+ * @param[in] context : pointer to ComposeLevelTask
+ */
+static void ComposeMonoTask(size_t monoID, void *context) {
+    ComposeLevelTask *task = context;
+    const Mono *m = &task->p->arr[monoID];
 
-/** See PolyComposeFrom. Composes monomial @p m with polynomials starting from index @p idx */
-static Poly MonoComposeFrom(const Mono *m, size_t idx, size_t k, const Poly q[]) {
-    Poly toCompose = (idx < k ? q[idx] : PolyZero());
-    Poly multinomial = PolyToPower(&toCompose, MonoGetExp(m));
+    if (task->ctx->shapes[task->idx] != SHAPE_GENERAL) {
+        task->partials[monoID] = MonoComposeMonoFrom(m, &task->ctx->q[task->idx], task->idx, task->ctx);
+        return;
+    }
 
-    /** Recursive composition of deeper polynomials */
-    Poly nextComposition = PolyComposeFrom(MonoGetPoly(m), idx + 1, k, q);
-    Poly resPoly = PolyMul(&multinomial, &nextComposition);
+    Poly multinomial = PolyPowerFromSquares(task->squares, MonoGetExp(m));
+    Poly nextComposition = PolyComposeFrom(MonoGetPoly(m), task->idx + 1, task->ctx);
+    task->partials[monoID] = PolyMul(&multinomial, &nextComposition);
 
     PolyDestroy(&multinomial);
     PolyDestroy(&nextComposition);
+}
+
+/**
+ * Adds a pair of partial results of a level, which are @p task->stride apart.
+ * @param[in] pairID : index of the pair
+ * @param[in] context : pointer to ComposeLevelTask
+ */
+static void ComposeSumTask(size_t pairID, void *context) {
+    ComposeLevelTask *task = context;
+    size_t firstID = 2 * pairID * task->stride, secondID = firstID + task->stride;
+
+    if (secondID < task->p->size) {
+        PolyAddTo(&task->partials[firstID], &task->partials[secondID]);
+        PolyDestroy(&task->partials[secondID]);
+    }
+}
+
+/**
+ * See PolyComposeFrom. Composes monomials of non-constant @p p in parallel and
+ * adds partial results in a reduction tree. Powers of a general inner polynomial
+ * are assembled from its squares, which are read-only once computed.
+ */
+static Poly PolyComposeParallelFrom(const Poly *p, size_t idx, const ComposeContext *ctx) {
+    ComposeContext sequentialCtx = *ctx;
+    sequentialCtx.parallel = false;
+
+    ComposeLevelTask task = {
+        .p = p,
+        .idx = idx,
+        .ctx = &sequentialCtx,
+        .squares = NULL,
+        .partials = malloc(p->size * sizeof(Poly))
+    };
+    CHECK_NULL_PTR(task.partials);
+
+    size_t squareCount = 0;
+    Poly *squares = NULL;
+
+    if (ctx->shapes[idx] == SHAPE_GENERAL) {
+        /* The highest exponent is the last one, as monomials are sorted */
+        for (poly_exp_t exp = MonoGetExp(&p->arr[p->size - 1]); exp != 0; exp /= 2)
+            squareCount++;
+
+        squares = malloc((squareCount + 1) * sizeof(Poly));
+        CHECK_NULL_PTR(squares);
+
+        for (size_t bit = 0; bit < squareCount; bit++)
+            squares[bit] = (bit == 0 ? PolyClone(&ctx->q[idx]) :
+                            PolyMul(&squares[bit - 1], &squares[bit - 1]));
+        task.squares = squares;
+    }
+
+    ParallelFor(p->size, ComposeMonoTask, &task);
+
+    for (task.stride = 1; task.stride < p->size; task.stride *= 2) {
+        size_t pairCount = (p->size + 2 * task.stride - 1) / (2 * task.stride);
+
+        if (pairCount >= COMPOSE_PARALLEL_MIN_PAIRS) {
+            ParallelFor(pairCount, ComposeSumTask, &task);
+        } else {
+            for (size_t pairID = 0; pairID < pairCount; pairID++)
+                ComposeSumTask(pairID, &task);
+        }
+    }
+
+    Poly resPoly = task.partials[0];
+
+    for (size_t bit = 0; bit < squareCount; bit++)
+        PolyDestroy(&squares[bit]);
+    free(squares);
+    free(task.partials);
 
     return resPoly;
 }
 
-/** See PolyCompose. Performs composition starting from polynomial with index @p idx */
-static Poly PolyComposeFrom(const Poly *p, size_t idx, size_t k, const Poly q[]) {
+/** Level of a composition waiting on the work stack for compositions of its coefficients. */
+typedef struct ComposeFrame {
+    const Poly *p;        ///< non-constant polynomial of the level
+    size_t      idx;      ///< index of the inner polynomial of the level
+    size_t      done;     ///< number of monomials already composed
+    size_t      count;    ///< number of monomials to compose
+    Poly        resPoly;  ///< sum of compositions of the composed monomials
+} ComposeFrame;
+
+/**
+ * Checks whether monomials of @p p composed at index @p idx should be split between threads.
+ * @param[in] p : non-constant polynomial
+ * @param[in] idx : index of the inner polynomial
+ * @param[in] ctx : composition
+ * @return Should the level be composed in parallel?
+ */
+static bool ComposeIsParallel(const Poly *p, size_t idx, const ComposeContext *ctx) {
+    if (!ctx->parallel || ctx->shapes[idx] == SHAPE_CONST)
+        return false;
+
+    size_t innerSize = (PolyIsCoeff(&ctx->q[idx]) ? 1 : ctx->q[idx].size);
+    return p->size * innerSize >= COMPOSE_PARALLEL_MIN_WORK;
+}
+
+/**
+ * Checks whether the inner polynomial at index @p idx is zero.
+ * @param[in] idx : index of the inner polynomial
+ * @param[in] ctx : composition
+ * @return Is the substituted polynomial zero?
+ */
+static bool ComposeSubstitutesZero(size_t idx, const ComposeContext *ctx) {
+    return idx >= ctx->k || PolyIsZero(&ctx->q[idx]);
+}
+
+/**
+ * Creates a frame composing non-constant @p p at index @p idx.
+ * @param[in] p : non-constant polynomial
+ * @param[in] idx : index of the inner polynomial
+ * @param[in] ctx : composition
+ * @return frame with no monomial composed
+ */
+static ComposeFrame ComposeFrameCreate(const Poly *p, size_t idx, const ComposeContext *ctx) {
+    ComposeFrame frame = {.p = p, .idx = idx, .done = 0, .count = p->size, .resPoly = PolyZero()};
+
+    /* Only the free term survives substituting zero */
+    if (ComposeSubstitutesZero(idx, ctx))
+        frame.count = (MonoGetExp(&p->arr[0]) == 0 ? 1 : 0);
+
+    return frame;
+}
+
+/**
+ * Gives the monomial of a frame whose coefficient is composed next. Constants
+ * are substituted with Horner's scheme, so their monomials go in descending order.
+ * @param[in] frame : frame
+ * @param[in] ctx : composition
+ * @return next monomial
+ */
+static const Mono* ComposeFrameMono(const ComposeFrame *frame, const ComposeContext *ctx) {
+    bool isHorner = ctx->shapes[frame->idx] == SHAPE_CONST && !ComposeSubstitutesZero(frame->idx, ctx);
+    return &frame->p->arr[isHorner ? frame->p->size - 1 - frame->done : frame->done];
+}
+
+/**
+ * Adds composition of the next monomial of a frame, given composition of its coefficient.
+ * @param[in] frame : frame
+ * @param[in] composition : composition of the coefficient, taken on property
+ * @param[in] ctx : composition
+ */
+static void ComposeFrameAccept(ComposeFrame *frame, Poly *composition, const ComposeContext *ctx) {
+    const Mono *m = ComposeFrameMono(frame, ctx);
+    const Poly *toCompose = (frame->idx < ctx->k ? &ctx->q[frame->idx] : NULL);
+    Poly power, product;
+
+    switch (ctx->shapes[frame->idx]) {
+        case SHAPE_CONST:
+            PolyAddTo(&frame->resPoly, composition);
+
+            if (toCompose && !PolyIsZero(toCompose)) {
+                poly_exp_t lowerExp = (m == frame->p->arr ? 0 : MonoGetExp(m - 1));
+                poly_exp_t expGap = MonoGetExp(m) - lowerExp;
+
+                if (expGap > 0) {
+                    Poly factor = PolyFromCoeff(NumberToPower(toCompose->coeff, expGap));
+                    PolyMulBy(&frame->resPoly, &factor);
+                }
+            }
+            break;
+        case SHAPE_VAR:
+        case SHAPE_MONO:
+            power = PolyMonoToPower(toCompose, MonoGetExp(m));
+            product = PolyMulByMono(composition, &power);
+            PolyAddTo(&frame->resPoly, &product);
+
+            PolyDestroy(&power);
+            PolyDestroy(&product);
+            break;
+        case SHAPE_GENERAL:
+            power = PolyToPower(toCompose, MonoGetExp(m));
+            product = PolyMul(&power, composition);
+            PolyAddTo(&frame->resPoly, &product);
+
+            PolyDestroy(&power);
+            PolyDestroy(&product);
+            break;
+    }
+
+    PolyDestroy(composition);
+    frame->done++;
+}
+
+/**
+ * See PolyCompose. Performs composition starting from polynomial with index @p idx.
+ * Levels are kept on an explicit work stack instead of the call stack.
+ */
+static Poly PolyComposeFrom(const Poly *p, size_t idx, const ComposeContext *ctx) {
     if (PolyIsCoeff(p))
         return PolyClone(p);
+    else if (ComposeIsParallel(p, idx, ctx))
+        return PolyComposeParallelFrom(p, idx, ctx);
 
-    Poly resPoly = PolyZero();
+    size_t size = 0, capacity = 1;
+    ComposeFrame *frames = malloc(capacity * sizeof(ComposeFrame));
+    CHECK_NULL_PTR(frames);
 
-    for (size_t curMonoID = 0; curMonoID < p->size; curMonoID++) {
-        Poly composition = MonoComposeFrom(&p->arr[curMonoID], idx, k, q);
-        PolyAddTo(&resPoly, &composition);
+    frames[size++] = ComposeFrameCreate(p, idx, ctx);
+
+    Poly composition = PolyZero();
+    bool hasComposition = false;
+
+    while (size > 0) {
+        ComposeFrame *frame = &frames[size - 1];
 
-        PolyDestroy(&composition);
+        if (hasComposition) {
+            ComposeFrameAccept(frame, &composition, ctx);
+            hasComposition = false;
+        }
+
+        if (frame->done == frame->count) {
+            composition = frame->resPoly;
+            hasComposition = true;
+            size--;
+            continue;
+        }
+
+        const Poly *coeffPoly = MonoGetPoly(ComposeFrameMono(frame, ctx));
+        size_t coeffIdx = frame->idx + 1;
+
+        if (PolyIsCoeff(coeffPoly) || ComposeIsParallel(coeffPoly, coeffIdx, ctx)) {
+            composition = PolyComposeFrom(coeffPoly, coeffIdx, ctx);
+            hasComposition = true;
+            continue;
+        }
+
+        if (size == capacity) {
+            capacity = 2 * capacity + 1;
+            frames = realloc(frames, capacity * sizeof(ComposeFrame));
+            CHECK_NULL_PTR(frames);
+        }
+
+        frames[size++] = ComposeFrameCreate(coeffPoly, coeffIdx, ctx);
     }
 
-    return resPoly;
+    free(frames);
+
+    return composition;
+}
+
+/**
+ * Checks whether inner polynomials of a composition only rename variables.
+ * @param[in] ctx : composition with classified shapes
+ * @param[in] levels : number of variables of the outer polynomial
+ * @return Are all shapes SHAPE_VAR with distinct variables?
+ */
+static bool ComposeIsRenaming(const ComposeContext *ctx, size_t levels) {
+    for (size_t idx = 0; idx < levels; idx++) {
+        if (ctx->shapes[idx] != SHAPE_VAR)
+            return false;
+
+        for (size_t prevIdx = 0; prevIdx < idx; prevIdx++) {
+            if (ctx->vars[prevIdx] == ctx->vars[idx])
+                return false;
+        }
+    }
+
+    return true;
 }
 
 Poly PolyCompose(const Poly *p, size_t k, const Poly q[]) {
-   return PolyComposeFrom(p, 0, k, q);
+    size_t levels = PolyVarCount(p);
+    ComposeContext ctx = {
+        .k = k,
+        .q = q,
+        .shapes = malloc((levels + 1) * sizeof(ComposeShape)),
+        .vars = malloc((levels + 1) * sizeof(size_t)),
+        .parallel = ParallelThreadCount() > 1
+    };
+    CHECK_NULL_PTR(ctx.shapes);
+    CHECK_NULL_PTR(ctx.vars);
+
+    for (size_t idx = 0; idx < levels; idx++) {
+        Poly toCompose = (idx < k ? q[idx] : PolyZero());
+        ctx.shapes[idx] = PolyComposeShape(&toCompose, &ctx.vars[idx]);
+    }
+
+    /* Substituting distinct variables only relabels the tree */
+    Poly resPoly = (levels > 0 && ComposeIsRenaming(&ctx, levels) ?
+                    PolyRenameVars(p, levels, ctx.vars) :
+                    PolyComposeFrom(p, 0, &ctx));
+
+    free(ctx.shapes);
+    free(ctx.vars);
+
+    return resPoly;
 }
@@ -157,6 +157,33 @@ static inline Mono MonoClone(const Mono *m) {
  */
 Poly PolyAdd(const Poly *p, const Poly *q);
 
+/**
+ * Computes a linear combination of two polynomials in a single merge
+ * of their monomials, without building scaled copies of the operands.
+ * @param[in] a : number @f$a@f$
+ * @param[in] p : poly @f$p@f$
+ * @param[in] b : number @f$b@f$
+ * @param[in] q : poly @f$q@f$
+ * @return @f$a p + b q@f$
+ */
+Poly PolyLinComb(poly_coeff_t a, const Poly *p, poly_coeff_t b, const Poly *q);
+
+/**
+ * Adds a polynomial multiplied by a number to an owned polynomial in place.
+ * Coefficients of @p p are reused rather than copied, so adding a small
+ * polynomial to a large one copies none of its subtrees. Monomials of
+ * @p p are kept in a sorted array, so each of its levels costs
+ * @f$O(|q| \log |p|)@f$ searches plus moving, in blocks, the monomials
+ * above the lowest exponent of @p q which is new or cancels out, i.e.
+ * @f$O(|p|)@f$ in the worst case, e.g. when a new free term is added.
+ * Adding @p q, whose exponents all occur in @p p without cancelling out,
+ * moves no monomial at all.
+ * @param[in,out] p : poly @f$p@f$, replaced by @f$p + c q@f$
+ * @param[in] c : number @f$c@f$
+ * @param[in] q : poly @f$q@f$, distinct from @p p
+ */
+void PolyAddScaledInPlace(Poly *p, poly_coeff_t c, const Poly *q);
+
 /**
  * Sums up a list of monomials. Takes
  * content of a @p monos on property.
@@ -184,6 +211,16 @@ Poly PolyOwnMonos(size_t count, Mono *monos);
  */
 Poly PolyCloneMonos(size_t count, const Mono monos[]);
 
+/**
+ * Sums up polynomials multiplied by numbers, merging all of them at once
+ * instead of adding them one by one.
+ * @param[in] count : number of polynomials
+ * @param[in] scales : numbers @f$c_0, c_1, \ldots@f$
+ * @param[in] polys : polynomials @f$p_0, p_1, \ldots@f$
+ * @return @f$c_0 p_0 + c_1 p_1 + \ldots@f$
+ */
+Poly PolySumScaled(size_t count, const poly_coeff_t scales[], const Poly *const polys[]);
+
 /**
  * Returns a multiplication of two polynomials.
  * @param[in] p : wielomian @f$p@f$
@@ -207,6 +244,20 @@ Poly PolyNeg(const Poly *p);
  */
 Poly PolySub(const Poly *p, const Poly *q);
 
+/**
+ * Multiplies a polynomial by a number in place, changing only its constant
+ * coefficients and removing monomials which become zero.
+ * @param[in,out] p : poly @f$p@f$, replaced by @f$c p@f$
+ * @param[in] c : number @f$c@f$
+ */
+void PolyScaleInPlace(Poly *p, poly_coeff_t c);
+
+/**
+ * Negates a polynomial in place, without allocating memory.
+ * @param[in,out] p : poly @f$p@f$, replaced by @f$-p@f$
+ */
+void PolyNegInPlace(Poly *p);
+
 /**
  * Returns a degree of a poly of a specific variable.
  * Result is -1 for constant polynomials.
@@ -243,7 +294,8 @@ Poly PolyAt(const Poly *p, poly_coeff_t x);
 /**
  * Composes poly @p with @p k polynomials from
  * an array @p q. If the length of @p is less than than @p k,
- * the rest of monomials are set to zero.
+ * the rest of monomials are set to zero. Polynomials from @p q
+ * beyond the number of variables of @p p are not accessed.
  * @param[in] p : outer poly @f$p@f$
  * @param[in] q : inner polynomials
  * @param[in] k : number of the inner
@@ -0,0 +1,809 @@
+/** @file
+  Implementation of evaluation of multi-variable polynomials at points.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "poly_eval.h"
+#include "poly_parallel.h"
+#include "poly_simd.h"
+#include "poly_terms.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Number of points evaluated together in vector lanes. */
+#define EVAL_LANES 8
+
+/** Number of points evaluated by a single task of a thread. */
+#define EVAL_TASK_POINTS 4096
+
+/**
+ * Type of intermediate values of evaluation. Unsigned arithmetic wraps
+ * around on overflow in the same way as operations on polynomials.
+ */
+typedef unsigned long eval_value_t;
+
+/**
+ * Raises @p base to the power @p exp by repeated squaring.
+ * @param[in] base : @f$x@f$
+ * @param[in] exp : @f$n@f$
+ * @return @f$x^n@f$
+ */
+static eval_value_t ValueToPower(eval_value_t base, poly_exp_t exp) {
+    eval_value_t resValue = 1;
+
+    for (; exp > 0; exp /= 2) {
+        if (exp % 2 == 1)
+            resValue *= base;
+        base *= base;
+    }
+
+    return resValue;
+}
+
+/**
+ * See PolyEvalPoint. Evaluates @p p, whose main variable is @f$x_{level}@f$.
+ */
+static eval_value_t PolyEvalFrom(const Poly *p, size_t level, size_t n, const poly_coeff_t xs[]) {
+    if (PolyIsCoeff(p))
+        return (eval_value_t) p->coeff;
+
+    eval_value_t x = (level < n ? (eval_value_t) xs[level] : 0);
+
+    /* Only the free term survives substituting zero */
+    if (x == 0) {
+        return MonoGetExp(&p->arr[0]) == 0 ?
+               PolyEvalFrom(MonoGetPoly(&p->arr[0]), level + 1, n, xs) : 0;
+    }
+
+    eval_value_t resValue = 0;
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+
+        resValue += PolyEvalFrom(MonoGetPoly(&p->arr[curMonoID]), level + 1, n, xs);
+        resValue *= ValueToPower(x, MonoGetExp(&p->arr[curMonoID]) - lowerExp);
+    }
+
+    return resValue;
+}
+
+poly_coeff_t PolyEvalPoint(const Poly *p, size_t n, const poly_coeff_t xs[]) {
+    return (poly_coeff_t) PolyEvalFrom(p, 0, n, xs);
+}
+
+/**
+ * See PolyEvalPoints. Evaluates @p p, whose main variable is @f$x_{level}@f$,
+ * at a block of EVAL_LANES points.
+ * @param[in] p : poly
+ * @param[in] level : index of the main variable of @p p
+ * @param[in] n : number of given coordinates of each point
+ * @param[in] points : EVAL_LANES points of @p n coordinates, one after another
+ * @param[in] values : destination for EVAL_LANES values
+ */
+POLY_SIMD_CLONES
+static void PolyEvalLanes(const Poly *p, size_t level, size_t n,
+                          const poly_coeff_t points[], eval_value_t values[EVAL_LANES]) {
+    if (PolyIsCoeff(p)) {
+        for (size_t lane = 0; lane < EVAL_LANES; lane++)
+            values[lane] = (eval_value_t) p->coeff;
+        return;
+    }
+
+    /* Only free terms survive substituting zero for all points */
+    if (level >= n) {
+        if (MonoGetExp(&p->arr[0]) == 0)
+            PolyEvalLanes(MonoGetPoly(&p->arr[0]), level + 1, n, points, values);
+        else
+            memset(values, 0, EVAL_LANES * sizeof(eval_value_t));
+        return;
+    }
+
+    eval_value_t xs[EVAL_LANES], coeffValues[EVAL_LANES], powers[EVAL_LANES], bases[EVAL_LANES];
+
+    for (size_t lane = 0; lane < EVAL_LANES; lane++) {
+        xs[lane] = (eval_value_t) points[lane * n + level];
+        values[lane] = 0;
+    }
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+        poly_exp_t exp = MonoGetExp(&p->arr[curMonoID]) - lowerExp;
+
+        PolyEvalLanes(MonoGetPoly(&p->arr[curMonoID]), level + 1, n, points, coeffValues);
+
+        for (size_t lane = 0; lane < EVAL_LANES; lane++) {
+            powers[lane] = 1;
+            bases[lane] = xs[lane];
+        }
+
+        for (; exp > 0; exp /= 2) {
+            for (size_t lane = 0; lane < EVAL_LANES; lane++) {
+                powers[lane] *= (exp % 2 == 1 ? bases[lane] : 1);
+                bases[lane] *= bases[lane];
+            }
+        }
+
+        for (size_t lane = 0; lane < EVAL_LANES; lane++)
+            values[lane] = (values[lane] + coeffValues[lane]) * powers[lane];
+    }
+}
+
+/** Arguments of PolyEvalPoints shared by its tasks. */
+typedef struct EvalPointsTask {
+    const Poly         *p;      ///< evaluated poly
+    size_t              n;      ///< number of given coordinates of each point
+    size_t              count;  ///< number of points
+    const poly_coeff_t *points; ///< points
+    poly_coeff_t       *values; ///< destination for values
+} EvalPointsTask;
+
+/**
+ * Evaluates a poly at EVAL_TASK_POINTS consecutive points.
+ * @param[in] taskID : index of the first point divided by EVAL_TASK_POINTS
+ * @param[in] context : pointer to EvalPointsTask
+ */
+static void EvalPointsTaskRun(size_t taskID, void *context) {
+    const EvalPointsTask *task = context;
+    size_t from = taskID * EVAL_TASK_POINTS;
+    size_t to = (from + EVAL_TASK_POINTS < task->count ? from + EVAL_TASK_POINTS : task->count);
+    eval_value_t laneValues[EVAL_LANES];
+    poly_coeff_t *padded = NULL;
+
+    for (size_t blockStart = from; blockStart < to; blockStart += EVAL_LANES) {
+        size_t blockSize = (to - blockStart < EVAL_LANES ? to - blockStart : EVAL_LANES);
+        const poly_coeff_t *blockPoints = &task->points[blockStart * task->n];
+
+        /* The last block is completed with zero points */
+        if (blockSize < EVAL_LANES) {
+            padded = calloc(EVAL_LANES * task->n + 1, sizeof(poly_coeff_t));
+            CHECK_NULL_PTR(padded);
+            memcpy(padded, blockPoints, blockSize * task->n * sizeof(poly_coeff_t));
+            blockPoints = padded;
+        }
+
+        PolyEvalLanes(task->p, 0, task->n, blockPoints, laneValues);
+
+        for (size_t lane = 0; lane < blockSize; lane++)
+            task->values[blockStart + lane] = (poly_coeff_t) laneValues[lane];
+    }
+
+    free(padded);
+}
+
+void PolyEvalPoints(const Poly *p, size_t n, size_t count,
+                    const poly_coeff_t points[], poly_coeff_t values[]) {
+    EvalPointsTask task = {.p = p, .n = n, .count = count, .points = points, .values = values};
+    ParallelFor((count + EVAL_TASK_POINTS - 1) / EVAL_TASK_POINTS, EvalPointsTaskRun, &task);
+}
+
+/** Power @f$x_{var}^{exp}@f$ requested by a step of a program under compilation. */
+typedef struct ProgramPower {
+    size_t     var;    ///< variable
+    poly_exp_t exp;    ///< exponent
+    size_t     stepID; ///< index of the step using the power
+} ProgramPower;
+
+/** State of a compilation of a program. */
+typedef struct ProgramBuilder {
+    PolyProgram   program;       ///< program under compilation
+    size_t        stepCapacity;  ///< number of steps which fit without reallocation
+    ProgramPower* powers;        ///< powers requested by steps
+    size_t        powerCapacity; ///< number of powers which fit without reallocation
+    size_t        height;        ///< current height of the operand stack
+} ProgramBuilder;
+
+/**
+ * Appends a step to a program under compilation.
+ * @param[in] builder : state of the compilation
+ * @param[in] step : step
+ */
+static void ProgramAppend(ProgramBuilder *builder, ProgramStep step) {
+    PolyProgram *program = &builder->program;
+
+    if (program->stepCount == builder->stepCapacity) {
+        builder->stepCapacity = 2 * builder->stepCapacity + 1;
+        program->steps = realloc(program->steps, builder->stepCapacity * sizeof(ProgramStep));
+        CHECK_NULL_PTR(program->steps);
+    }
+
+    if (step.op == OP_PUSH_CONST && ++builder->height > program->depth)
+        program->depth = builder->height;
+    else if (step.op == OP_ADD)
+        builder->height--;
+
+    program->steps[program->stepCount++] = step;
+}
+
+/**
+ * Appends a multiplication by @f$x_{var}^{exp}@f$ to a program under compilation.
+ * @param[in] builder : state of the compilation
+ * @param[in] var : variable
+ * @param[in] exp : exponent
+ */
+static void ProgramAppendPower(ProgramBuilder *builder, size_t var, poly_exp_t exp) {
+    size_t powerID = builder->program.powerCount++;
+
+    if (powerID == builder->powerCapacity) {
+        builder->powerCapacity = 2 * builder->powerCapacity + 1;
+        builder->powers = realloc(builder->powers, builder->powerCapacity * sizeof(ProgramPower));
+        CHECK_NULL_PTR(builder->powers);
+    }
+
+    builder->powers[powerID] = (ProgramPower) {.var = var, .exp = exp, .stepID = builder->program.stepCount};
+    ProgramAppend(builder, (ProgramStep) {.op = OP_MUL_POWER, .arg.power = powerID});
+}
+
+/**
+ * Appends steps pushing the value of @p p, whose main variable is
+ * @f$x_{level}@f$, on the operand stack.
+ * @param[in] builder : state of the compilation
+ * @param[in] p : poly
+ * @param[in] level : index of the main variable of @p p
+ */
+static void ProgramCompileFrom(ProgramBuilder *builder, const Poly *p, size_t level) {
+    if (PolyIsCoeff(p)) {
+        ProgramAppend(builder, (ProgramStep) {.op = OP_PUSH_CONST, .arg.coeff = p->coeff});
+        return;
+    }
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        const Poly *coeffPoly = MonoGetPoly(&p->arr[curMonoID]);
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+
+        if (curMonoID + 1 == p->size) {
+            ProgramCompileFrom(builder, coeffPoly, level + 1);
+        } else if (PolyIsCoeff(coeffPoly)) {
+            ProgramAppend(builder, (ProgramStep) {.op = OP_ADD_CONST, .arg.coeff = coeffPoly->coeff});
+        } else {
+            ProgramCompileFrom(builder, coeffPoly, level + 1);
+            ProgramAppend(builder, (ProgramStep) {.op = OP_ADD});
+        }
+
+        if (MonoGetExp(&p->arr[curMonoID]) > lowerExp)
+            ProgramAppendPower(builder, level, MonoGetExp(&p->arr[curMonoID]) - lowerExp);
+    }
+}
+
+/**
+ * Compares requested powers by variables and then by exponents.
+ * @param[in] a : pointer to ProgramPower
+ * @param[in] b : pointer to ProgramPower
+ * @return negative, zero or positive as in qsort
+ */
+static int ProgramPowerCompare(const void *a, const void *b) {
+    const ProgramPower *first = a, *second = b;
+
+    if (first->var != second->var)
+        return first->var < second->var ? -1 : 1;
+
+    return (first->exp > second->exp) - (first->exp < second->exp);
+}
+
+PolyProgram PolyCompileEvaluator(const Poly *p) {
+    ProgramBuilder builder = {.program = {.stepCount = 0, .steps = NULL, .powerCount = 0, .depth = 0, .values = NULL},
+                              .stepCapacity = 0, .powers = NULL, .powerCapacity = 0, .height = 0};
+    ProgramCompileFrom(&builder, p, 0);
+
+    /* Requested powers become a table of distinct ones */
+    PolyProgram program = builder.program;
+    size_t requested = program.powerCount;
+    if (requested > 0)
+        qsort(builder.powers, requested, sizeof(ProgramPower), ProgramPowerCompare);
+
+    program.powerCount = 0;
+    program.powerVars = malloc((requested + 1) * sizeof(size_t));
+    program.powerExps = malloc((requested + 1) * sizeof(poly_exp_t));
+    CHECK_NULL_PTR(program.powerVars);
+    CHECK_NULL_PTR(program.powerExps);
+
+    for (size_t powerID = 0; powerID < requested; powerID++) {
+        const ProgramPower *power = &builder.powers[powerID];
+
+        if (powerID == 0 || ProgramPowerCompare(power, &builder.powers[powerID - 1]) != 0) {
+            program.powerVars[program.powerCount] = power->var;
+            program.powerExps[program.powerCount] = power->exp;
+            program.powerCount++;
+        }
+
+        program.steps[power->stepID].arg.power = program.powerCount - 1;
+    }
+
+    free(builder.powers);
+
+    program.values = malloc((program.powerCount + program.depth + 1) * sizeof(eval_value_t));
+    CHECK_NULL_PTR(program.values);
+
+    return program;
+}
+
+poly_coeff_t ProgramEvalPoint(const PolyProgram *program, size_t n, const poly_coeff_t xs[]) {
+    /* Operands are stored right after the power table */
+    eval_value_t *powers = program->values;
+
+    for (size_t powerID = 0; powerID < program->powerCount; powerID++) {
+        size_t var = program->powerVars[powerID];
+        eval_value_t x = (var < n ? (eval_value_t) xs[var] : 0);
+
+        if (powerID > 0 && program->powerVars[powerID - 1] == var) {
+            poly_exp_t step = program->powerExps[powerID] - program->powerExps[powerID - 1];
+            powers[powerID] = powers[powerID - 1] * ValueToPower(x, step);
+        } else {
+            powers[powerID] = ValueToPower(x, program->powerExps[powerID]);
+        }
+    }
+
+    eval_value_t *top = &powers[program->powerCount] - 1;
+    const ProgramStep *step = program->steps, *end = program->steps + program->stepCount;
+
+    for (; step != end; step++) {
+        switch (step->op) {
+            case OP_PUSH_CONST:
+                *++top = (eval_value_t) step->arg.coeff;
+                break;
+            case OP_ADD_CONST:
+                *top += (eval_value_t) step->arg.coeff;
+                break;
+            case OP_ADD:
+                top--;
+                *top += top[1];
+                break;
+            case OP_MUL_POWER:
+                *top *= powers[step->arg.power];
+                break;
+        }
+    }
+
+    return (poly_coeff_t) *top;
+}
+
+void ProgramDestroy(PolyProgram *program) {
+    free(program->steps);
+    free(program->powerVars);
+    free(program->powerExps);
+    free(program->values);
+}
+
+/**
+ * Converts a coefficient to a double, together with the rounding error.
+ * @param[in] coeff : coefficient
+ * @param[in] error : destination for the rounding error, may be NULL
+ * @return nearest double
+ */
+static inline double CoeffToDouble(poly_coeff_t coeff, double *error) {
+    double value = (double) coeff;
+
+    /* Rounded values beyond 2^62 are even and their halves fit in poly_coeff_t */
+    if (error && fabs(value) < 0x1p62) {
+        *error = (double) (coeff - (poly_coeff_t) value);
+    } else if (error) {
+        poly_coeff_t half = (poly_coeff_t) (value / 2);
+        *error = (double) ((coeff - half) - half);
+    }
+
+    return value;
+}
+
+/**
+ * Multiplies a double-double number @f$h + l@f$ by @f$bh + bl@f$.
+ * @param[in] h : high part of the number to update
+ * @param[in] l : low part of the number to update
+ * @param[in] bh : high part of the factor
+ * @param[in] bl : low part of the factor
+ */
+static inline void DoubleDoubleMulBy(double *h, double *l, double bh, double bl) {
+    double product = *h * bh;
+    *l = fma(*h, bh, -product) + (*h * bl + *l * bh);
+    *h = product;
+}
+
+/**
+ * Raises @p base to the power @p exp by repeated squaring. If @p lo is not NULL,
+ * squaring is done in double-double arithmetic and the low part is stored there.
+ * @param[in] base : @f$x@f$
+ * @param[in] exp : @f$n@f$
+ * @param[in] lo : destination for the low part of the power, may be NULL
+ * @return @f$x^n@f$ rounded to a double
+ */
+static inline double DoubleToPower(double base, poly_exp_t exp, double *lo) {
+    double resHigh = 1, resLow = 0, baseLow = 0;
+
+    for (; exp > 0; exp /= 2) {
+        if (lo) {
+            if (exp % 2 == 1)
+                DoubleDoubleMulBy(&resHigh, &resLow, base, baseLow);
+            if (exp > 1)
+                DoubleDoubleMulBy(&base, &baseLow, base, baseLow);
+        } else {
+            resHigh *= (exp % 2 == 1 ? base : 1);
+            base *= base;
+        }
+    }
+
+    if (lo)
+        *lo = resLow;
+
+    return resHigh;
+}
+
+/**
+ * Performs a step @f$v \leftarrow v \cdot (ph + pl) + a@f$ of compensated Horner's
+ * scheme. Rounding errors of the step, of the power and of @f$a@f$ are
+ * accumulated in @p error.
+ * @param[in] value : value @f$v@f$ to update
+ * @param[in] error : error of @f$v@f$ to update
+ * @param[in] ph : high part of the power
+ * @param[in] pl : low part of the power
+ * @param[in] a : added value @f$a@f$
+ * @param[in] aError : error of @f$a@f$
+ */
+static inline void CompensatedHornerStep(double *value, double *error, double ph, double pl,
+                                         double a, double aError) {
+    double product = *value * ph;
+    double productError = fma(*value, ph, -product);
+    double sum = product + a;
+    double sumCorrection = sum - product;
+    double sumError = (product - (sum - sumCorrection)) + (a - sumCorrection);
+
+    *error = fma(*error, ph, *value * pl + productError + sumError + aError);
+    *value = sum;
+}
+
+/**
+ * See PolyEvalDouble. Evaluates @p p, whose main variable is @f$x_{level}@f$.
+ * The error of the value is stored in @p error, unless it is NULL.
+ */
+POLY_FMA_CLONES
+static double PolyEvalDoubleFrom(const Poly *p, size_t level, size_t n, const double xs[], double *error) {
+    if (PolyIsCoeff(p))
+        return CoeffToDouble(p->coeff, error);
+
+    double x = (level < n ? xs[level] : 0);
+
+    /* Only the free term survives substituting zero */
+    if (x == 0 && MonoGetExp(&p->arr[0]) > 0) {
+        if (error)
+            *error = 0;
+        return 0;
+    } else if (x == 0) {
+        return PolyEvalDoubleFrom(MonoGetPoly(&p->arr[0]), level + 1, n, xs, error);
+    }
+
+    double resValue = PolyEvalDoubleFrom(MonoGetPoly(&p->arr[p->size - 1]), level + 1, n, xs, error);
+    double coeffValue, coeffError = 0, powerLow = 0;
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+        double power = DoubleToPower(x, MonoGetExp(&p->arr[curMonoID]) - lowerExp, error ? &powerLow : NULL);
+
+        /* The lowest exponent is multiplied without adding a coefficient */
+        coeffValue = (curMonoID > 0 ?
+                      PolyEvalDoubleFrom(MonoGetPoly(&p->arr[curMonoID - 1]), level + 1, n, xs,
+                                         error ? &coeffError : NULL) : 0);
+
+        if (error) {
+            CompensatedHornerStep(&resValue, error, power, powerLow, coeffValue, curMonoID > 0 ? coeffError : 0);
+        } else {
+            resValue = fma(resValue, power, coeffValue);
+        }
+    }
+
+    return resValue;
+}
+
+double PolyEvalDouble(const Poly *p, size_t n, const double xs[], bool compensated) {
+    if (!compensated)
+        return PolyEvalDoubleFrom(p, 0, n, xs, NULL);
+
+    double error = 0;
+    double resValue = PolyEvalDoubleFrom(p, 0, n, xs, &error);
+
+    /* Errors of infinite values are meaningless */
+    return isfinite(error) ? resValue + error : resValue;
+}
+
+/**
+ * See PolyEvalDoublePoints. Evaluates @p p, whose main variable is @f$x_{level}@f$,
+ * at a block of EVAL_LANES points.
+ * @param[in] p : poly
+ * @param[in] level : index of the main variable of @p p
+ * @param[in] n : number of given coordinates of each point
+ * @param[in] points : EVAL_LANES points of @p n coordinates, one after another
+ * @param[in] values : destination for EVAL_LANES values
+ * @param[in] errors : destination for errors of values, NULL for the plain scheme
+ */
+POLY_FMA_CLONES
+static void PolyEvalDoubleLanes(const Poly *p, size_t level, size_t n, const double points[],
+                                double values[EVAL_LANES], double errors[EVAL_LANES]) {
+    if (PolyIsCoeff(p)) {
+        for (size_t lane = 0; lane < EVAL_LANES; lane++)
+            values[lane] = CoeffToDouble(p->coeff, errors ? &errors[lane] : NULL);
+        return;
+    }
+
+    /* Only free terms survive substituting zero for all points */
+    if (level >= n && MonoGetExp(&p->arr[0]) > 0) {
+        memset(values, 0, EVAL_LANES * sizeof(double));
+        if (errors)
+            memset(errors, 0, EVAL_LANES * sizeof(double));
+        return;
+    } else if (level >= n) {
+        PolyEvalDoubleLanes(MonoGetPoly(&p->arr[0]), level + 1, n, points, values, errors);
+        return;
+    }
+
+    double xs[EVAL_LANES], coeffValues[EVAL_LANES], coeffErrors[EVAL_LANES];
+    double powers[EVAL_LANES], powersLow[EVAL_LANES];
+
+    for (size_t lane = 0; lane < EVAL_LANES; lane++)
+        xs[lane] = points[lane * n + level];
+
+    PolyEvalDoubleLanes(MonoGetPoly(&p->arr[p->size - 1]), level + 1, n, points, values, errors);
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+        poly_exp_t exp = MonoGetExp(&p->arr[curMonoID]) - lowerExp;
+
+        /* The lowest exponent is multiplied without adding a coefficient */
+        if (curMonoID > 0) {
+            PolyEvalDoubleLanes(MonoGetPoly(&p->arr[curMonoID - 1]), level + 1, n, points,
+                                coeffValues, errors ? coeffErrors : NULL);
+        } else {
+            memset(coeffValues, 0, EVAL_LANES * sizeof(double));
+            memset(coeffErrors, 0, EVAL_LANES * sizeof(double));
+        }
+
+        for (size_t lane = 0; lane < EVAL_LANES; lane++)
+            powers[lane] = DoubleToPower(xs[lane], exp, errors ? &powersLow[lane] : NULL);
+
+        if (errors) {
+            for (size_t lane = 0; lane < EVAL_LANES; lane++) {
+                CompensatedHornerStep(&values[lane], &errors[lane], powers[lane], powersLow[lane],
+                                      coeffValues[lane], coeffErrors[lane]);
+            }
+        } else {
+            for (size_t lane = 0; lane < EVAL_LANES; lane++)
+                values[lane] = fma(values[lane], powers[lane], coeffValues[lane]);
+        }
+    }
+}
+
+/** Arguments of PolyEvalDoublePoints shared by its tasks. */
+typedef struct EvalDoublePointsTask {
+    const Poly   *p;           ///< evaluated poly
+    size_t        n;           ///< number of given coordinates of each point
+    size_t        count;       ///< number of points
+    const double *points;      ///< points
+    double       *values;      ///< destination for values
+    bool          compensated; ///< should compensated Horner's scheme be used?
+} EvalDoublePointsTask;
+
+/**
+ * Evaluates a poly at EVAL_TASK_POINTS consecutive points in double precision.
+ * @param[in] taskID : index of the first point divided by EVAL_TASK_POINTS
+ * @param[in] context : pointer to EvalDoublePointsTask
+ */
+static void EvalDoublePointsTaskRun(size_t taskID, void *context) {
+    const EvalDoublePointsTask *task = context;
+    size_t from = taskID * EVAL_TASK_POINTS;
+    size_t to = (from + EVAL_TASK_POINTS < task->count ? from + EVAL_TASK_POINTS : task->count);
+    double laneValues[EVAL_LANES], laneErrors[EVAL_LANES];
+    double *padded = NULL;
+
+    for (size_t blockStart = from; blockStart < to; blockStart += EVAL_LANES) {
+        size_t blockSize = (to - blockStart < EVAL_LANES ? to - blockStart : EVAL_LANES);
+        const double *blockPoints = &task->points[blockStart * task->n];
+
+        /* The last block is completed with zero points */
+        if (blockSize < EVAL_LANES) {
+            padded = calloc(EVAL_LANES * task->n + 1, sizeof(double));
+            CHECK_NULL_PTR(padded);
+            memcpy(padded, blockPoints, blockSize * task->n * sizeof(double));
+            blockPoints = padded;
+        }
+
+        PolyEvalDoubleLanes(task->p, 0, task->n, blockPoints, laneValues,
+                            task->compensated ? laneErrors : NULL);
+
+        for (size_t lane = 0; lane < blockSize; lane++) {
+            bool corrected = task->compensated && isfinite(laneErrors[lane]);
+            task->values[blockStart + lane] = laneValues[lane] + (corrected ? laneErrors[lane] : 0);
+        }
+    }
+
+    free(padded);
+}
+
+void PolyEvalDoublePoints(const Poly *p, size_t n, size_t count, const double points[],
+                          double values[], bool compensated) {
+    EvalDoublePointsTask task = {.p = p, .n = n, .count = count, .points = points,
+                                 .values = values, .compensated = compensated};
+    ParallelFor((count + EVAL_TASK_POINTS - 1) / EVAL_TASK_POINTS, EvalDoublePointsTaskRun, &task);
+}
+
+/** Mersenne prime @f$2^{61} - 1@f$, modulus of probabilistic identity checks. */
+#define CHECK_MODULUS ((((uint64_t) 1) << 61) - 1)
+
+/**
+ * Multiplies two residues modulo CHECK_MODULUS.
+ * @param[in] a : residue @f$a@f$
+ * @param[in] b : residue @f$b@f$
+ * @return @f$a b \bmod (2^{61} - 1)@f$
+ */
+static inline uint64_t ModMul(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128) a * b;
+    uint64_t resValue = (uint64_t) (product & CHECK_MODULUS) + (uint64_t) (product >> 61);
+
+    resValue = (resValue & CHECK_MODULUS) + (resValue >> 61);
+    return (resValue >= CHECK_MODULUS ? resValue - CHECK_MODULUS : resValue);
+}
+
+/**
+ * Adds two residues modulo CHECK_MODULUS.
+ * @param[in] a : residue @f$a@f$
+ * @param[in] b : residue @f$b@f$
+ * @return @f$a + b \bmod (2^{61} - 1)@f$
+ */
+static inline uint64_t ModAdd(uint64_t a, uint64_t b) {
+    uint64_t resValue = a + b;
+    return (resValue >= CHECK_MODULUS ? resValue - CHECK_MODULUS : resValue);
+}
+
+/**
+ * Reduces a coefficient modulo CHECK_MODULUS.
+ * @param[in] coeff : coefficient
+ * @return residue of @p coeff
+ */
+static inline uint64_t CoeffToResidue(poly_coeff_t coeff) {
+    uint64_t magnitude = (coeff < 0 ? -(uint64_t) coeff : (uint64_t) coeff) % CHECK_MODULUS;
+    return (coeff < 0 && magnitude > 0 ? CHECK_MODULUS - magnitude : magnitude);
+}
+
+/**
+ * Raises a residue to the power @p exp modulo CHECK_MODULUS.
+ * @param[in] base : residue @f$x@f$
+ * @param[in] exp : @f$n@f$
+ * @return @f$x^n \bmod (2^{61} - 1)@f$
+ */
+static uint64_t ResidueToPower(uint64_t base, poly_exp_t exp) {
+    uint64_t resValue = 1;
+
+    for (; exp > 0; exp /= 2) {
+        if (exp % 2 == 1)
+            resValue = ModMul(resValue, base);
+        base = ModMul(base, base);
+    }
+
+    return resValue;
+}
+
+/**
+ * Evaluates @p p, whose main variable is @f$x_{level}@f$, modulo CHECK_MODULUS
+ * at the point @f$(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$ of residues.
+ * @param[in] p : poly
+ * @param[in] level : index of the main variable of @p p
+ * @param[in] n : number of given coordinates
+ * @param[in] xs : coordinates
+ * @return residue of the value
+ */
+static uint64_t PolyEvalResidueFrom(const Poly *p, size_t level, size_t n, const uint64_t xs[]) {
+    if (PolyIsCoeff(p))
+        return CoeffToResidue(p->coeff);
+
+    uint64_t x = (level < n ? xs[level] : 0);
+
+    /* Only the free term survives substituting zero */
+    if (x == 0) {
+        return MonoGetExp(&p->arr[0]) == 0 ?
+               PolyEvalResidueFrom(MonoGetPoly(&p->arr[0]), level + 1, n, xs) : 0;
+    }
+
+    uint64_t resValue = 0;
+
+    for (size_t curMonoID = p->size; curMonoID-- > 0;) {
+        poly_exp_t lowerExp = (curMonoID > 0 ? MonoGetExp(&p->arr[curMonoID - 1]) : 0);
+
+        resValue = ModAdd(resValue, PolyEvalResidueFrom(MonoGetPoly(&p->arr[curMonoID]), level + 1, n, xs));
+        resValue = ModMul(resValue, ResidueToPower(x, MonoGetExp(&p->arr[curMonoID]) - lowerExp));
+    }
+
+    return resValue;
+}
+
+/**
+ * Draws a random residue modulo CHECK_MODULUS with the splitmix64 generator,
+ * seeded with the time of the first call.
+ * @return random residue
+ */
+static uint64_t RandomResidue(void) {
+    static uint64_t state = 0;
+
+    if (state == 0)
+        state = (uint64_t) time(NULL) | 1;
+
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+
+    return z % CHECK_MODULUS;
+}
+
+/**
+ * Creates an array of @p n random residues.
+ * @param[in] n : length of the array
+ * @return array of residues
+ */
+static uint64_t* RandomPoint(size_t n) {
+    uint64_t *point = malloc((n + 1) * sizeof(uint64_t));
+    CHECK_NULL_PTR(point);
+
+    for (size_t i = 0; i < n; i++)
+        point[i] = RandomResidue();
+
+    return point;
+}
+
+/**
+ * Returns the greater of two sizes.
+ * @param[in] a : size
+ * @param[in] b : size
+ * @return @f$\max(a, b)@f$
+ */
+static inline size_t SizeMax(size_t a, size_t b) {
+    return (a > b ? a : b);
+}
+
+bool PolyCheckMul(const Poly *p, const Poly *q, const Poly *r, size_t rounds) {
+    size_t n = SizeMax(SizeMax(PolyVarCount(p), PolyVarCount(q)), PolyVarCount(r));
+    bool equal = true;
+
+    for (size_t round = 0; round < rounds && equal; round++) {
+        uint64_t *point = RandomPoint(n);
+
+        uint64_t product = ModMul(PolyEvalResidueFrom(p, 0, n, point), PolyEvalResidueFrom(q, 0, n, point));
+        equal = (product == PolyEvalResidueFrom(r, 0, n, point));
+
+        free(point);
+    }
+
+    return equal;
+}
+
+bool PolyCheckCompose(const Poly *p, size_t k, const Poly q[], const Poly *r, size_t rounds) {
+    /* Inner polynomials beyond the variables of p are not substituted anywhere */
+    size_t used = PolyVarCount(p);
+    if (used > k)
+        used = k;
+
+    size_t n = PolyVarCount(r);
+    for (size_t i = 0; i < used; i++)
+        n = SizeMax(n, PolyVarCount(&q[i]));
+
+    uint64_t *innerValues = malloc((used + 1) * sizeof(uint64_t));
+    CHECK_NULL_PTR(innerValues);
+    bool equal = true;
+
+    for (size_t round = 0; round < rounds && equal; round++) {
+        uint64_t *point = RandomPoint(n);
+
+        for (size_t i = 0; i < used; i++)
+            innerValues[i] = PolyEvalResidueFrom(&q[i], 0, n, point);
+
+        equal = (PolyEvalResidueFrom(p, 0, used, innerValues) == PolyEvalResidueFrom(r, 0, n, point));
+
+        free(point);
+    }
+
+    free(innerValues);
+
+    return equal;
+}
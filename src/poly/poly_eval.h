@@ -0,0 +1,147 @@
+/** @file
+  Interface of evaluation of multi-variable polynomials at points.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_EVAL_H
+#define POLYNOMIALS_POLY_EVAL_H
+
+#include "poly.h"
+
+/**
+ * Evaluates the poly at the point @f$(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$
+ * with Horner's scheme, without allocating memory.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] n : number of given coordinates
+ * @param[in] xs : coordinates @f$x_0, x_1, \ldots, x_{n-1}@f$
+ * @return @f$p(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$
+ */
+poly_coeff_t PolyEvalPoint(const Poly *p, size_t n, const poly_coeff_t xs[]);
+
+/**
+ * Evaluates the poly at many points, as PolyEvalPoint does for a single one.
+ * The tree is traversed once for a block of points evaluated together in
+ * vector lanes, and blocks are split between threads.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] n : number of given coordinates of each point
+ * @param[in] count : number of points
+ * @param[in] points : @p count points of @p n coordinates, one after another
+ * @param[in] values : destination for @p count values
+ */
+void PolyEvalPoints(const Poly *p, size_t n, size_t count,
+                    const poly_coeff_t points[], poly_coeff_t values[]);
+
+/**
+ * Evaluates the poly at the point @f$(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$
+ * in double precision with Horner's scheme using fused multiply-add, without
+ * allocating memory. Compensated Horner's scheme additionally tracks rounding
+ * errors, so the value is as accurate as if computed with twice the precision.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] n : number of given coordinates
+ * @param[in] xs : coordinates @f$x_0, x_1, \ldots, x_{n-1}@f$
+ * @param[in] compensated : should compensated Horner's scheme be used?
+ * @return approximation of @f$p(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$
+ */
+double PolyEvalDouble(const Poly *p, size_t n, const double xs[], bool compensated);
+
+/**
+ * Evaluates the poly at many points, as PolyEvalDouble does for a single one.
+ * Blocks of points are evaluated together in vector lanes and split between threads.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] n : number of given coordinates of each point
+ * @param[in] count : number of points
+ * @param[in] points : @p count points of @p n coordinates, one after another
+ * @param[in] values : destination for @p count values
+ * @param[in] compensated : should compensated Horner's scheme be used?
+ */
+void PolyEvalDoublePoints(const Poly *p, size_t n, size_t count, const double points[],
+                          double values[], bool compensated);
+
+/**
+ * Checks probabilistically whether @f$r = p q@f$ over the integers, comparing
+ * values at random points modulo the prime @f$2^{61} - 1@f$ without expanding
+ * the product. A false positive in a single round has probability at most
+ * @f$\deg(r - p q) / (2^{61} - 1)@f$. Products computed by PolyMul, whose
+ * coefficients wrapped around, differ from @f$p q@f$ over the integers,
+ * so they are reported as unequal.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] q : poly @f$q@f$
+ * @param[in] r : claimed product @f$r@f$
+ * @param[in] rounds : number of random points
+ * @return Is @f$r = p q@f$ at all random points?
+ */
+bool PolyCheckMul(const Poly *p, const Poly *q, const Poly *r, size_t rounds);
+
+/**
+ * Checks probabilistically whether @p r is the composition PolyCompose(@p p, @p k, @p q),
+ * in the same way as PolyCheckMul does for products.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] k : number of inner polynomials
+ * @param[in] q : inner polynomials @f$q_0, \ldots, q_{k-1}@f$
+ * @param[in] r : claimed composition @f$r@f$
+ * @param[in] rounds : number of random points
+ * @return Is @f$r = p(q_0, \ldots, q_{k-1}, 0, \ldots)@f$ at all random points?
+ */
+bool PolyCheckCompose(const Poly *p, size_t k, const Poly q[], const Poly *r, size_t rounds);
+
+/** Operations of compiled evaluation programs. */
+typedef enum ProgramOp {
+    OP_PUSH_CONST, ///< pushes a constant on the operand stack
+    OP_ADD_CONST,  ///< adds a constant to the top operand
+    OP_ADD,        ///< pops the top operand and adds it to the next one
+    OP_MUL_POWER   ///< multiplies the top operand by an entry of the power table
+} ProgramOp;
+
+/** Type representing a single step of an evaluation program. */
+typedef struct ProgramStep {
+    ProgramOp op; ///< operation
+    union {
+        poly_coeff_t coeff; ///< constant of OP_PUSH_CONST and OP_ADD_CONST
+        size_t       power; ///< power table entry of OP_MUL_POWER
+    } arg;        ///< argument of the operation
+} ProgramStep;
+
+/**
+ * Type representing a poly compiled to a straight-line program. Powers
+ * @f$x_{var}^{exp}@f$ used by the program are computed once per point, in the
+ * order of the table, each from the previous power of the same variable.
+ */
+typedef struct PolyProgram {
+    size_t         stepCount;  ///< number of steps
+    ProgramStep*   steps;      ///< steps of Horner's scheme
+    size_t         powerCount; ///< number of entries of the power table
+    size_t*        powerVars;  ///< variables of powers, non-decreasing
+    poly_exp_t*    powerExps;  ///< exponents of powers, increasing for each variable
+    size_t         depth;      ///< maximal height of the operand stack
+    unsigned long* values;     ///< memory of the power table and the operand stack, so running allocates nothing
+} PolyProgram;
+
+/**
+ * Compiles a poly to a program, which evaluates it without traversing the
+ * tree. Equal powers of variables are computed once for all monomials.
+ * @param[in] p : poly @f$p@f$
+ * @return program evaluating @f$p@f$
+ */
+PolyProgram PolyCompileEvaluator(const Poly *p);
+
+/**
+ * Runs a compiled program at a point, as PolyEvalPoint does for the poly.
+ * Memory of the program is reused, so nothing is allocated, and a program
+ * cannot be run by several threads at once.
+ * @param[in] program : program compiled from a poly @f$p@f$
+ * @param[in] n : number of given coordinates
+ * @param[in] xs : coordinates @f$x_0, x_1, \ldots, x_{n-1}@f$
+ * @return @f$p(x_0, x_1, \ldots, x_{n-1}, 0, 0, \ldots)@f$
+ */
+poly_coeff_t ProgramEvalPoint(const PolyProgram *program, size_t n, const poly_coeff_t xs[]);
+
+/**
+ * Clears an allocated memory for a program.
+ * @param[in] program : program
+ */
+void ProgramDestroy(PolyProgram *program);
+
+#endif //POLYNOMIALS_POLY_EVAL_H
@@ -0,0 +1,346 @@
+/** @file
+  Implementation of lazy expressions over multi-variable polynomials.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "poly_expr.h"
+#include "poly_terms.h"
+#include "poly_serial.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Stack of expression nodes used instead of recursion on deep expressions. */
+typedef struct ExprWorkStack {
+    size_t     size;     ///< number of nodes
+    size_t     capacity; ///< number of nodes which fit without reallocation
+    PolyExpr** nodes;    ///< nodes
+} ExprWorkStack;
+
+/**
+ * Pushes a node to a work stack.
+ * @param[in] stack : work stack
+ * @param[in] e : node
+ */
+static void WorkStackPush(ExprWorkStack* stack, PolyExpr* e) {
+    if (stack->size == stack->capacity) {
+        stack->capacity = 2 * stack->capacity + 1;
+        stack->nodes = realloc(stack->nodes, stack->capacity * sizeof(PolyExpr*));
+        CHECK_NULL_PTR(stack->nodes);
+    }
+
+    stack->nodes[stack->size++] = e;
+}
+
+/**
+ * Creates a node of a given kind without arguments.
+ * @param[in] kind : kind of the node
+ * @return node of a single reference
+ */
+static PolyExpr* ExprCreate(ExprKind kind) {
+    PolyExpr* e = malloc(sizeof(PolyExpr));
+    CHECK_NULL_PTR(e);
+
+    *e = (PolyExpr) {
+        .kind = kind,
+        .refCount = 1,
+        .forced = false,
+        .value = PolyZero(),
+        .count = 0,
+        .capacity = 0,
+        .args = NULL,
+        .scales = NULL,
+        .nextArg = 0,
+        .serial = NULL,
+        .serialLength = 0
+    };
+
+    return e;
+}
+
+PolyExpr* ExprFromPoly(Poly p) {
+    PolyExpr* e = ExprCreate(EXPR_POLY);
+    e->forced = true;
+    e->value = p;
+    return e;
+}
+
+PolyExpr* ExprFromSerialized(const uint8_t* serial, size_t length) {
+    PolyExpr* e = ExprCreate(EXPR_SERIAL);
+    e->serial = serial;
+    e->serialLength = length;
+    return e;
+}
+
+PolyExpr* ExprShare(PolyExpr* e) {
+    e->refCount++;
+    return e;
+}
+
+/**
+ * Frees arguments of a node, dropping references to them.
+ * @param[in] e : node
+ * @param[in] pending : work stack for nodes to release
+ */
+static void ExprDropArgs(PolyExpr* e, ExprWorkStack* pending) {
+    for (size_t argID = 0; argID < e->count; argID++)
+        WorkStackPush(pending, e->args[argID]);
+
+    free(e->args);
+    free(e->scales);
+    e->args = NULL;
+    e->scales = NULL;
+    e->count = e->capacity = 0;
+}
+
+/**
+ * Releases all nodes of a work stack, leaving it empty.
+ * @param[in] pending : work stack
+ */
+static void WorkStackRelease(ExprWorkStack* pending) {
+    while (pending->size > 0) {
+        PolyExpr* e = pending->nodes[--pending->size];
+        if (--e->refCount > 0)
+            continue;
+
+        ExprDropArgs(e, pending);
+        PolyDestroy(&e->value);
+        free(e);
+    }
+}
+
+void ExprRelease(PolyExpr* e) {
+    ExprWorkStack pending = {.size = 0, .capacity = 0, .nodes = NULL};
+    WorkStackPush(&pending, e);
+    WorkStackRelease(&pending);
+    free(pending.nodes);
+}
+
+/**
+ * Checks whether a node may be extended in place, i.e. it is an operation
+ * of a given kind, which is neither shared nor materialized.
+ * @param[in] e : node
+ * @param[in] kind : kind of operation
+ * @return Is the node an open operation of kind @p kind?
+ */
+static bool ExprIsOpen(const PolyExpr* e, ExprKind kind) {
+    return e->kind == kind && e->refCount == 1 && !e->forced;
+}
+
+/**
+ * Checks whether a node is a materialized constant.
+ * @param[in] e : node
+ * @return Is the node a constant?
+ */
+static bool ExprIsCoeff(const PolyExpr* e) {
+    return e->forced && PolyIsCoeff(&e->value);
+}
+
+/**
+ * Appends an argument to a node.
+ * @param[in] e : node
+ * @param[in] arg : argument, whose reference is taken
+ * @param[in] scale : number multiplying the argument of a sum
+ */
+static void ExprAppendArg(PolyExpr* e, PolyExpr* arg, poly_coeff_t scale) {
+    if (e->count == e->capacity) {
+        e->capacity = 2 * e->capacity + 2;
+        e->args = realloc(e->args, e->capacity * sizeof(PolyExpr*));
+        e->scales = realloc(e->scales, e->capacity * sizeof(poly_coeff_t));
+        CHECK_NULL_PTR(e->args);
+        CHECK_NULL_PTR(e->scales);
+    }
+
+    e->args[e->count] = arg;
+    e->scales[e->count++] = scale;
+}
+
+/**
+ * Moves arguments of an open node to another node of the same kind and frees it.
+ * @param[in] e : node to extend
+ * @param[in] from : open node
+ * @param[in] scale : number multiplying moved arguments of a sum
+ */
+static void ExprSpliceArgs(PolyExpr* e, PolyExpr* from, poly_coeff_t scale) {
+    for (size_t argID = 0; argID < from->count; argID++)
+        ExprAppendArg(e, from->args[argID], from->scales[argID] * scale);
+
+    free(from->args);
+    free(from->scales);
+    free(from);
+}
+
+/**
+ * Appends a scaled term to an open sum, flattening open sums.
+ * @param[in] sum : open sum
+ * @param[in] term : term, whose reference is taken
+ * @param[in] scale : number multiplying the term
+ */
+static void ExprSumAppend(PolyExpr* sum, PolyExpr* term, poly_coeff_t scale) {
+    if (ExprIsOpen(term, EXPR_SUM))
+        ExprSpliceArgs(sum, term, scale);
+    else
+        ExprAppendArg(sum, term, scale);
+}
+
+PolyExpr* ExprScale(PolyExpr* a, poly_coeff_t scale) {
+    if (ExprIsOpen(a, EXPR_SUM)) {
+        for (size_t argID = 0; argID < a->count; argID++)
+            a->scales[argID] *= scale;
+        return a;
+    } else if (ExprIsCoeff(a)) {
+        PolyExpr* scaled = ExprFromPoly(PolyFromCoeff(a->value.coeff * scale));
+        ExprRelease(a);
+        return scaled;
+    }
+
+    PolyExpr* sum = ExprCreate(EXPR_SUM);
+    ExprAppendArg(sum, a, scale);
+    return sum;
+}
+
+/**
+ * Creates an expression of a sum @f$a + scale \cdot b@f$.
+ * @param[in] a : expression, whose reference is taken
+ * @param[in] b : expression, whose reference is taken
+ * @param[in] scale : number multiplying @p b
+ * @return @f$a + scale \cdot b@f$
+ */
+static PolyExpr* ExprCombine(PolyExpr* a, PolyExpr* b, poly_coeff_t scale) {
+    PolyExpr* sum = a;
+
+    if (!ExprIsOpen(a, EXPR_SUM)) {
+        sum = ExprCreate(EXPR_SUM);
+        ExprAppendArg(sum, a, 1);
+    }
+
+    ExprSumAppend(sum, b, scale);
+    return sum;
+}
+
+PolyExpr* ExprAdd(PolyExpr* a, PolyExpr* b) {
+    return ExprCombine(a, b, 1);
+}
+
+PolyExpr* ExprSub(PolyExpr* a, PolyExpr* b) {
+    return ExprCombine(a, b, -1);
+}
+
+PolyExpr* ExprNeg(PolyExpr* a) {
+    return ExprScale(a, -1);
+}
+
+PolyExpr* ExprMul(PolyExpr* a, PolyExpr* b) {
+    if (ExprIsCoeff(a)) {
+        poly_coeff_t scale = a->value.coeff;
+        ExprRelease(a);
+        return ExprScale(b, scale);
+    } else if (ExprIsCoeff(b)) {
+        poly_coeff_t scale = b->value.coeff;
+        ExprRelease(b);
+        return ExprScale(a, scale);
+    }
+
+    PolyExpr* product = a;
+
+    if (!ExprIsOpen(a, EXPR_PRODUCT)) {
+        product = ExprCreate(EXPR_PRODUCT);
+        ExprAppendArg(product, a, 1);
+    }
+
+    if (ExprIsOpen(b, EXPR_PRODUCT))
+        ExprSpliceArgs(product, b, 1);
+    else
+        ExprAppendArg(product, b, 1);
+
+    return product;
+}
+
+/**
+ * Computes the value of a node, whose arguments are materialized.
+ * @param[in] e : node
+ * @param[in] pending : work stack for arguments to release
+ */
+static void ExprEvaluate(PolyExpr* e, ExprWorkStack* pending) {
+    if (e->kind == EXPR_SERIAL) {
+        size_t consumed = 0;
+        /* Representations are checked when they are restored, so only bytes changed since then get here */
+        if (!PolyDeserialize(e->serial, e->serialLength, &e->value, &consumed) ||
+            consumed != e->serialLength) {
+            fputs("Damaged binary representation of a polynomial\n", stderr);
+            exit(1);
+        }
+    } else if (e->kind == EXPR_SUM) {
+        const Poly** values = malloc(e->count * sizeof(Poly*));
+        CHECK_NULL_PTR(values);
+
+        for (size_t argID = 0; argID < e->count; argID++)
+            values[argID] = &e->args[argID]->value;
+
+        e->value = PolySumScaled(e->count, e->scales, values);
+        free(values);
+    } else {
+        e->value = PolyMulReordered(&e->args[0]->value, &e->args[1]->value);
+
+        for (size_t argID = 2; argID < e->count; argID++) {
+            Poly product = PolyMulReordered(&e->value, &e->args[argID]->value);
+            PolyDestroy(&e->value);
+            e->value = product;
+        }
+    }
+
+    e->forced = true;
+    ExprDropArgs(e, pending);
+}
+
+const Poly* ExprForce(PolyExpr* e) {
+    ExprWorkStack unforced = {.size = 0, .capacity = 0, .nodes = NULL};
+    ExprWorkStack pending = {.size = 0, .capacity = 0, .nodes = NULL};
+
+    if (!e->forced)
+        WorkStackPush(&unforced, e);
+
+    /* Arguments are materialized before their node, each shared node once */
+    while (unforced.size > 0) {
+        PolyExpr* node = unforced.nodes[unforced.size - 1];
+
+        while (node->nextArg < node->count && node->args[node->nextArg]->forced)
+            node->nextArg++;
+
+        if (node->forced) {
+            unforced.size--;
+        } else if (node->nextArg < node->count) {
+            WorkStackPush(&unforced, node->args[node->nextArg]);
+        } else {
+            ExprEvaluate(node, &pending);
+            unforced.size--;
+        }
+
+        /* Arguments are released as soon as they are used */
+        WorkStackRelease(&pending);
+    }
+
+    free(unforced.nodes);
+    free(pending.nodes);
+
+    return &e->value;
+}
+
+Poly ExprTake(PolyExpr* e) {
+    ExprForce(e);
+
+    if (e->refCount > 1) {
+        e->refCount--;
+        return PolyClone(&e->value);
+    }
+
+    Poly value = e->value;
+    free(e);
+
+    return value;
+}
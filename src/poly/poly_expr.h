@@ -0,0 +1,130 @@
+/** @file
+  Interface of lazy expressions over multi-variable polynomials.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_EXPR_H
+#define POLYNOMIALS_POLY_EXPR_H
+
+#include <stdint.h>
+
+#include "poly.h"
+
+/** Kinds of expression nodes. */
+typedef enum ExprKind {
+    EXPR_POLY,    ///< materialized polynomial
+    EXPR_SUM,     ///< sum of arguments multiplied by numbers
+    EXPR_PRODUCT, ///< product of arguments
+    EXPR_SERIAL   ///< polynomial in the binary representation
+} ExprKind;
+
+/**
+ * Type representing a node of an expression DAG. Nodes are reference
+ * counted, so a subexpression shared by many expressions is materialized
+ * once. A materialized node keeps its value and drops its arguments.
+ */
+typedef struct PolyExpr {
+    ExprKind          kind;         ///< kind of the node
+    size_t            refCount;     ///< number of references to the node
+    bool              forced;       ///< is @p value computed?
+    Poly              value;        ///< value of a materialized node
+    size_t            count;        ///< number of arguments
+    size_t            capacity;     ///< number of arguments which fit without reallocation
+    struct PolyExpr** args;         ///< arguments
+    poly_coeff_t*     scales;       ///< numbers multiplying arguments of a sum
+    size_t            nextArg;      ///< first argument which may not be materialized yet
+    const uint8_t*    serial;       ///< binary representation of a serialized polynomial
+    size_t            serialLength; ///< number of bytes of @p serial
+} PolyExpr;
+
+/**
+ * Creates a materialized expression. Takes @p p on property.
+ * @param[in] p : poly
+ * @return expression of a single reference
+ */
+PolyExpr* ExprFromPoly(Poly p);
+
+/**
+ * Creates an expression of a polynomial in the binary representation
+ * of PolySerialize, which is read only when the expression is materialized.
+ * Bytes have to be checked by PolySerialCheck and stay valid and unchanged
+ * until then. Bytes damaged in the meantime end the program with a message.
+ * @param[in] serial : binary representation
+ * @param[in] length : number of bytes
+ * @return expression of a single reference
+ */
+PolyExpr* ExprFromSerialized(const uint8_t* serial, size_t length);
+
+/**
+ * Adds a reference to an expression.
+ * @param[in] e : expression
+ * @return @p e
+ */
+PolyExpr* ExprShare(PolyExpr* e);
+
+/**
+ * Drops a reference to an expression, freeing the nodes which are no longer referenced.
+ * @param[in] e : expression
+ */
+void ExprRelease(PolyExpr* e);
+
+/**
+ * Creates an expression of a sum. Takes references to @p a and @p b,
+ * and extends a sum which is not shared instead of nesting it.
+ * @param[in] a : expression @f$a@f$
+ * @param[in] b : expression @f$b@f$
+ * @return @f$a + b@f$
+ */
+PolyExpr* ExprAdd(PolyExpr* a, PolyExpr* b);
+
+/**
+ * Creates an expression of a subtraction, as ExprAdd does for a sum.
+ * @param[in] a : expression @f$a@f$
+ * @param[in] b : expression @f$b@f$
+ * @return @f$a - b@f$
+ */
+PolyExpr* ExprSub(PolyExpr* a, PolyExpr* b);
+
+/**
+ * Creates an expression of a negation. Takes the reference to @p a.
+ * @param[in] a : expression @f$a@f$
+ * @return @f$-a@f$
+ */
+PolyExpr* ExprNeg(PolyExpr* a);
+
+/**
+ * Creates an expression of a number multiplying another expression.
+ * Takes the reference to @p a.
+ * @param[in] a : expression @f$a@f$
+ * @param[in] scale : number @f$c@f$
+ * @return @f$c a@f$
+ */
+PolyExpr* ExprScale(PolyExpr* a, poly_coeff_t scale);
+
+/**
+ * Creates an expression of a product. Takes references to @p a and @p b.
+ * A constant factor becomes a number multiplying the other one.
+ * @param[in] a : expression @f$a@f$
+ * @param[in] b : expression @f$b@f$
+ * @return @f$a * b@f$
+ */
+PolyExpr* ExprMul(PolyExpr* a, PolyExpr* b);
+
+/**
+ * Materializes an expression. The value stays owned by the expression.
+ * @param[in] e : expression
+ * @return value of @p e
+ */
+const Poly* ExprForce(PolyExpr* e);
+
+/**
+ * Materializes an expression and drops the reference to it.
+ * @param[in] e : expression
+ * @return value of @p e, moved out of the last reference or cloned
+ */
+Poly ExprTake(PolyExpr* e);
+
+#endif //POLYNOMIALS_POLY_EXPR_H
@@ -0,0 +1,196 @@
+/** @file
+  Implementation of a thread pool for polynomial operations.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "poly_parallel.h"
+
+/** Number of threads set by ParallelSetThreadCount, zero for the default. */
+static atomic_size_t threadCountOverride = 0;
+
+/** Default number of threads, zero until it is first needed. */
+static atomic_size_t threadCountDefault = 0;
+
+/** State of a parallel loop shared by its workers. */
+typedef struct ParallelLoop {
+    atomic_size_t nextTaskID; ///< first index not taken by any worker
+    size_t        taskCount;  ///< number of tasks
+    ParallelTask  task;       ///< task to execute
+    void*         context;    ///< argument of the task
+} ParallelLoop;
+
+/**
+ * Workers, which live as long as the program and wait for loops. The thread
+ * calling ParallelFor takes part in its loop, so a loop of @p n threads
+ * is helped by @p n - 1 workers.
+ */
+typedef struct ParallelPool {
+    pthread_mutex_t lock;        ///< guards all other fields
+    pthread_cond_t  wake;        ///< signalled when a loop starts
+    pthread_cond_t  finished;    ///< signalled when a worker leaves a loop
+    size_t          workerCount; ///< number of started workers
+    size_t          generation;  ///< number of started loops
+    ParallelLoop*   loop;        ///< current loop or NULL if there is none
+    size_t          helpers;     ///< number of workers taking part in the current loop
+    size_t          busy;        ///< number of helpers, which have not left the current loop
+} ParallelPool;
+
+/** Pool of the program. */
+static ParallelPool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .finished = PTHREAD_COND_INITIALIZER,
+    .workerCount = 0,
+    .generation = 0,
+    .loop = NULL,
+    .helpers = 0,
+    .busy = 0
+};
+
+/** Is the thread executing tasks of a loop? Loops started by tasks run in their thread. */
+static _Thread_local bool insideLoop = false;
+
+size_t ParallelThreadCount(void) {
+    size_t threads = atomic_load(&threadCountOverride);
+    if (threads > 0)
+        return threads;
+
+    /* The environment and the processor count are read once, sysconf may read files */
+    threads = atomic_load(&threadCountDefault);
+    if (threads > 0)
+        return threads;
+
+    const char* variable = getenv("POLY_THREADS");
+    long parsed = (variable ? strtol(variable, NULL, 10) : 0);
+    if (parsed <= 0)
+        parsed = sysconf(_SC_NPROCESSORS_ONLN);
+
+    threads = (parsed > 0 ? (size_t) parsed : 1);
+    atomic_store(&threadCountDefault, threads);
+
+    return threads;
+}
+
+void ParallelSetThreadCount(size_t threads) {
+    atomic_store(&threadCountOverride, threads);
+}
+
+/**
+ * Executes tasks of a loop until none is left.
+ * @param[in] loop : loop
+ */
+static void ParallelRun(ParallelLoop* loop) {
+    for (;;) {
+        size_t taskID = atomic_fetch_add(&loop->nextTaskID, 1);
+        if (taskID >= loop->taskCount)
+            break;
+        loop->task(taskID, loop->context);
+    }
+}
+
+/**
+ * Waits for loops and helps with those, in which the worker takes part.
+ * @param[in] workerID : index of the worker cast to a pointer
+ * @return never returns
+ */
+static void* ParallelWorker(void* workerID) {
+    size_t id = (size_t) (uintptr_t) workerID;
+    size_t seenGeneration = 0;
+
+    insideLoop = true;
+    pthread_mutex_lock(&pool.lock);
+
+    /* Every helper leaves a loop before the next one starts, so no loop is missed */
+    for (;;) {
+        while (pool.generation == seenGeneration)
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        seenGeneration = pool.generation;
+
+        if (id >= pool.helpers)
+            continue;
+
+        ParallelLoop* loop = pool.loop;
+        pthread_mutex_unlock(&pool.lock);
+
+        ParallelRun(loop);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0)
+            pthread_cond_signal(&pool.finished);
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts workers until there are @p workers of them. The pool has to be locked.
+ * @param[in] workers : number of workers
+ */
+static void ParallelPoolGrow(size_t workers) {
+    while (pool.workerCount < workers) {
+        pthread_t thread;
+
+        /* A worker which failed to start only leaves more tasks to the others */
+        if (pthread_create(&thread, NULL, ParallelWorker, (void*) (uintptr_t) pool.workerCount) != 0)
+            return;
+
+        pthread_detach(thread);
+        pool.workerCount++;
+    }
+}
+
+void ParallelFor(size_t taskCount, ParallelTask task, void* context) {
+    size_t helpers = ParallelThreadCount() - 1;
+    if (helpers + 1 > taskCount)
+        helpers = (taskCount > 0 ? taskCount - 1 : 0);
+
+    ParallelLoop loop = {.taskCount = taskCount, .task = task, .context = context};
+    atomic_init(&loop.nextTaskID, 0);
+
+    bool published = false;
+
+    if (helpers > 0 && !insideLoop) {
+        pthread_mutex_lock(&pool.lock);
+
+        /* Loops of other threads, which are not workers, do not share the pool */
+        if (!pool.loop) {
+            ParallelPoolGrow(helpers);
+            if (helpers > pool.workerCount)
+                helpers = pool.workerCount;
+
+            pool.loop = &loop;
+            pool.helpers = pool.busy = helpers;
+            pool.generation++;
+            pthread_cond_broadcast(&pool.wake);
+            published = true;
+        }
+
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    bool wasInsideLoop = insideLoop;
+    insideLoop = true;
+    ParallelRun(&loop);
+    insideLoop = wasInsideLoop;
+
+    if (!published)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0)
+        pthread_cond_wait(&pool.finished, &pool.lock);
+    pool.loop = NULL;
+    pthread_mutex_unlock(&pool.lock);
+}
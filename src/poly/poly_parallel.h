@@ -0,0 +1,43 @@
+/** @file
+  Interface of a thread pool for polynomial operations.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_PARALLEL_H
+#define POLYNOMIALS_POLY_PARALLEL_H
+
+#include <stddef.h>
+
+/** Type of a task executed for every index of a parallel loop. */
+typedef void (*ParallelTask)(size_t taskID, void* context);
+
+/**
+ * Returns the number of threads used by parallel loops. By default it is
+ * the value of the POLY_THREADS environment variable or the number of
+ * online processors, read at the first call.
+ * @return number of threads
+ */
+size_t ParallelThreadCount(void);
+
+/**
+ * Overrides the number of threads used by parallel loops.
+ * @param[in] threads : number of threads, zero restores the default
+ */
+void ParallelSetThreadCount(size_t threads);
+
+/**
+ * Executes @p task for every index from [0, @p taskCount) and waits for
+ * all of them. Tasks are distributed dynamically between the calling thread
+ * and workers of a pool, which are started by the first loop needing them
+ * and then wait for further loops. Tasks have to be independent of each
+ * other. A loop started by a task runs in the thread of the task.
+ * @param[in] taskCount : number of tasks
+ * @param[in] task : task to execute
+ * @param[in] context : argument passed to every task
+ */
+void ParallelFor(size_t taskCount, ParallelTask task, void* context);
+
+#endif //POLYNOMIALS_POLY_PARALLEL_H
@@ -0,0 +1,369 @@
+/** @file
+  Implementation of a binary representation of polynomials.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include "poly_serial.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Encoded lengths of sums, in the order in which they are written. */
+typedef struct BodyLengths {
+    size_t* lengths;  ///< lengths
+    size_t  count;    ///< number of lengths
+    size_t  capacity; ///< number of lengths which fit without reallocation
+} BodyLengths;
+
+/** Sum of monomials, which is being read. */
+typedef struct ReadFrame {
+    Mono*      monos;        ///< read monomials, NULL if they are only checked
+    size_t     size;         ///< number of monomials of the sum
+    size_t     count;        ///< number of read monomials
+    poly_exp_t exp;          ///< exponent of the monomial being read
+    size_t     end;          ///< position after the last byte of the sum
+    bool       firstIsCoeff; ///< is the coefficient of the first monomial constant?
+} ReadFrame;
+
+/** State of reading of a binary representation. */
+typedef struct SerialReader {
+    const uint8_t* source;   ///< bytes
+    size_t         length;   ///< number of bytes
+    size_t         pos;      ///< position of the next byte
+    ReadFrame*     frames;   ///< sums being read, the innermost one on top
+    size_t         depth;    ///< number of sums being read
+    size_t         capacity; ///< number of frames which fit without reallocation
+    bool           build;    ///< are polynomials built, or is the representation only checked?
+} SerialReader;
+
+/**
+ * Maps a coefficient to an unsigned number, which is small for coefficients of a small magnitude.
+ * @param[in] c : coefficient
+ * @return @f$2c@f$ for non-negative @f$c@f$ and @f$-2c-1@f$ otherwise
+ */
+static inline uint64_t ZigZagEncode(poly_coeff_t c) {
+    return ((uint64_t) c << 1) ^ (c < 0 ? UINT64_MAX : 0);
+}
+
+/**
+ * Reverses ZigZagEncode.
+ * @param[in] v : encoded coefficient
+ * @return coefficient
+ */
+static inline poly_coeff_t ZigZagDecode(uint64_t v) {
+    uint64_t magnitude = v >> 1;
+    return ((v & 1) ? -(poly_coeff_t) magnitude - 1 : (poly_coeff_t) magnitude);
+}
+
+/**
+ * Computes the number of bytes of a varint.
+ * @param[in] v : number
+ * @return number of bytes
+ */
+static inline size_t VarintSize(uint64_t v) {
+    size_t size = 1;
+    for (; v >= 0x80; v >>= 7)
+        size++;
+    return size;
+}
+
+/**
+ * Writes a varint, seven bits per byte with the highest bit set in all but the last byte.
+ * @param[in] dest : destination
+ * @param[in] v : number
+ * @return position after the varint
+ */
+static inline uint8_t* VarintWrite(uint8_t* dest, uint64_t v) {
+    for (; v >= 0x80; v >>= 7)
+        *dest++ = (uint8_t) (v | 0x80);
+    *dest++ = (uint8_t) v;
+    return dest;
+}
+
+/**
+ * Reserves a place for a length of a sum.
+ * @param[in] bodies : list of lengths
+ * @return index of the place
+ */
+static size_t BodyLengthsReserve(BodyLengths* bodies) {
+    if (bodies->count == bodies->capacity) {
+        bodies->capacity = 2 * bodies->capacity + 1;
+        bodies->lengths = realloc(bodies->lengths, bodies->capacity * sizeof(size_t));
+        CHECK_NULL_PTR(bodies->lengths);
+    }
+
+    return bodies->count++;
+}
+
+/**
+ * Computes the number of bytes of a binary representation of a polynomial
+ * and optionally collects the lengths of its sums.
+ * @param[in] p : polynomial
+ * @param[in] bodies : list to append lengths of sums to, may be NULL
+ * @return number of bytes
+ */
+static size_t SerialMeasure(const Poly* p, BodyLengths* bodies) {
+    if (PolyIsCoeff(p))
+        return VarintSize(0) + VarintSize(ZigZagEncode(p->coeff));
+
+    /* Length of a sum is written before its monomials, so it is reserved before them */
+    size_t bodyID = (bodies ? BodyLengthsReserve(bodies) : 0);
+    size_t body = 0;
+    poly_exp_t previousExp = 0;
+
+    for (size_t monoID = 0; monoID < p->size; monoID++) {
+        const Mono* m = &p->arr[monoID];
+        body += VarintSize((uint64_t) ((int64_t) m->exp - previousExp)) + SerialMeasure(&m->p, bodies);
+        previousExp = m->exp;
+    }
+
+    if (bodies)
+        bodies->lengths[bodyID] = body;
+
+    return VarintSize(p->size) + VarintSize(body) + body;
+}
+
+/**
+ * Writes a binary representation of a polynomial.
+ * @param[in] p : polynomial
+ * @param[in] bodies : lengths of sums collected by SerialMeasure
+ * @param[in] bodyID : index of the length of the next sum
+ * @param[in] dest : destination
+ * @return position after the representation
+ */
+static uint8_t* SerialWrite(const Poly* p, const BodyLengths* bodies, size_t* bodyID, uint8_t* dest) {
+    if (PolyIsCoeff(p)) {
+        dest = VarintWrite(dest, 0);
+        return VarintWrite(dest, ZigZagEncode(p->coeff));
+    }
+
+    dest = VarintWrite(dest, p->size);
+    dest = VarintWrite(dest, bodies->lengths[(*bodyID)++]);
+
+    poly_exp_t previousExp = 0;
+
+    for (size_t monoID = 0; monoID < p->size; monoID++) {
+        const Mono* m = &p->arr[monoID];
+        dest = VarintWrite(dest, (uint64_t) ((int64_t) m->exp - previousExp));
+        dest = SerialWrite(&m->p, bodies, bodyID, dest);
+        previousExp = m->exp;
+    }
+
+    return dest;
+}
+
+size_t PolySerializedSize(const Poly *p) {
+    return SerialMeasure(p, NULL);
+}
+
+void PolySerialize(const Poly *p, uint8_t *dest) {
+    BodyLengths bodies = {.lengths = NULL, .count = 0, .capacity = 0};
+    size_t bodyID = 0;
+
+    SerialMeasure(p, &bodies);
+    SerialWrite(p, &bodies, &bodyID, dest);
+
+    free(bodies.lengths);
+}
+
+/**
+ * Reads a varint.
+ * @param[in] reader : reader
+ * @param[out] v : read number
+ * @return Was the varint correct?
+ */
+static bool ReaderVarint(SerialReader* reader, uint64_t* v) {
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 64 && reader->pos < reader->length; shift += 7) {
+        uint8_t byte = reader->source[reader->pos++];
+
+        /* The tenth byte holds only the highest bit */
+        if (shift == 63 && byte > 1)
+            return false;
+
+        value |= (uint64_t) (byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            *v = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Reads the exponent of the next monomial of the innermost sum.
+ * @param[in] reader : reader
+ * @return Is the exponent correct and greater than the previous one?
+ */
+static bool ReaderExp(SerialReader* reader) {
+    ReadFrame* frame = &reader->frames[reader->depth - 1];
+    uint64_t difference;
+
+    if (!ReaderVarint(reader, &difference) || (frame->count > 0 && difference == 0) ||
+        difference > (uint64_t) (INT_MAX - frame->exp))
+        return false;
+
+    frame->exp += (poly_exp_t) difference;
+
+    return true;
+}
+
+/**
+ * Starts reading of a sum of monomials.
+ * @param[in] reader : reader
+ * @param[in] size : number of monomials
+ * @return Is the length of the sum correct?
+ */
+static bool ReaderPushFrame(SerialReader* reader, uint64_t size) {
+    uint64_t body;
+
+    /* Every monomial takes at least two bytes, which bounds allocated memory */
+    if (!ReaderVarint(reader, &body) || body > reader->length - reader->pos || size > body / 2)
+        return false;
+
+    if (reader->depth == reader->capacity) {
+        reader->capacity = 2 * reader->capacity + 1;
+        reader->frames = realloc(reader->frames, reader->capacity * sizeof(ReadFrame));
+        CHECK_NULL_PTR(reader->frames);
+    }
+
+    Mono* monos = NULL;
+    if (reader->build) {
+        monos = malloc(size * sizeof(Mono));
+        CHECK_NULL_PTR(monos);
+    }
+
+    reader->frames[reader->depth++] = (ReadFrame) {
+        .monos = monos,
+        .size = size,
+        .count = 0,
+        .exp = 0,
+        .end = reader->pos + body,
+        .firstIsCoeff = false
+    };
+
+    return ReaderExp(reader);
+}
+
+/**
+ * Reads a polynomial in a single pass. Every sum of monomials gets a frame,
+ * which collects its monomials until all of them are read. A reader, which
+ * does not build polynomials, reads every sum as a non-zero constant.
+ * @param[in] reader : reader
+ * @param[out] value : read polynomial, or a part of it in case of an error
+ * @return Was the representation correct?
+ */
+static bool ReaderRun(SerialReader* reader, Poly* value) {
+    for (;;) {
+        uint64_t size;
+        if (!ReaderVarint(reader, &size))
+            return false;
+
+        if (size > 0) {
+            if (!ReaderPushFrame(reader, size))
+                return false;
+            continue;
+        }
+
+        uint64_t coeff;
+        if (!ReaderVarint(reader, &coeff))
+            return false;
+
+        *value = PolyFromCoeff(ZigZagDecode(coeff));
+        bool valueIsCoeff = true;
+
+        /* The polynomial is a coefficient of a monomial, unless it is the whole representation */
+        for (;;) {
+            if (reader->depth == 0)
+                return true;
+
+            ReadFrame* frame = &reader->frames[reader->depth - 1];
+
+            if (PolyIsZero(value))
+                return false;
+
+            if (frame->count == 0)
+                frame->firstIsCoeff = valueIsCoeff;
+            if (frame->monos)
+                frame->monos[frame->count] = (Mono) {.p = *value, .exp = frame->exp};
+            frame->count++;
+            *value = PolyZero();
+
+            if (frame->count < frame->size) {
+                if (!ReaderExp(reader))
+                    return false;
+                break;
+            }
+
+            /* A single constant monomial of exponent zero should have been a constant */
+            if (reader->pos != frame->end ||
+                (frame->size == 1 && frame->exp == 0 && frame->firstIsCoeff))
+                return false;
+
+            *value = (frame->monos ? (Poly) {.size = frame->size, .arr = frame->monos} : PolyFromCoeff(1));
+            valueIsCoeff = false;
+            reader->depth--;
+        }
+    }
+}
+
+bool PolyDeserialize(const uint8_t *source, size_t length, Poly *p, size_t *consumed) {
+    SerialReader reader = {
+        .source = source,
+        .length = length,
+        .pos = 0,
+        .frames = NULL,
+        .depth = 0,
+        .capacity = 0,
+        .build = true
+    };
+
+    Poly value = PolyZero();
+    bool correct = ReaderRun(&reader, &value);
+
+    if (correct) {
+        *p = value;
+        if (consumed)
+            *consumed = reader.pos;
+    } else {
+        PolyDestroy(&value);
+
+        for (size_t frameID = 0; frameID < reader.depth; frameID++) {
+            ReadFrame* frame = &reader.frames[frameID];
+            for (size_t monoID = 0; monoID < frame->count; monoID++)
+                MonoDestroy(&frame->monos[monoID]);
+            free(frame->monos);
+        }
+    }
+
+    free(reader.frames);
+
+    return correct;
+}
+
+bool PolySerialCheck(const uint8_t *source, size_t length) {
+    SerialReader reader = {
+        .source = source,
+        .length = length,
+        .pos = 0,
+        .frames = NULL,
+        .depth = 0,
+        .capacity = 0,
+        .build = false
+    };
+
+    Poly value = PolyZero();
+    bool correct = (ReaderRun(&reader, &value) && reader.pos == length);
+
+    free(reader.frames);
+
+    return correct;
+}
@@ -0,0 +1,59 @@
+/** @file
+  Interface of a binary representation of polynomials.
+
+  A polynomial is encoded as an unsigned varint (LEB128) number of its
+  monomials. A constant polynomial has zero monomials, and its coefficient
+  follows as a zigzag varint. Otherwise a varint length of the rest of the
+  encoding follows, which allows skipping the whole subtree, and then the
+  monomials in the increasing order of exponents. Every monomial is
+  a varint difference between its exponent and the previous one (zero
+  for the first monomial), followed by its coefficient.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_SERIAL_H
+#define POLYNOMIALS_POLY_SERIAL_H
+
+#include <stdint.h>
+
+#include "poly.h"
+
+/**
+ * Computes the number of bytes of a binary representation of a polynomial.
+ * @param[in] p : polynomial
+ * @return number of bytes
+ */
+size_t PolySerializedSize(const Poly *p);
+
+/**
+ * Writes a binary representation of a polynomial.
+ * @param[in] p : polynomial
+ * @param[out] dest : destination of PolySerializedSize(@p p) bytes
+ */
+void PolySerialize(const Poly *p, uint8_t *dest);
+
+/**
+ * Reads a polynomial from its binary representation, directly from
+ * the source bytes. Representations of polynomials, which are not
+ * in their normal form, are rejected.
+ * @param[in] source : bytes
+ * @param[in] length : number of bytes
+ * @param[out] p : read polynomial
+ * @param[out] consumed : destination for the number of read bytes, may be NULL
+ * @return Did the bytes begin with a correct representation?
+ */
+bool PolyDeserialize(const uint8_t *source, size_t length, Poly *p, size_t *consumed);
+
+/**
+ * Checks that bytes are exactly a representation, which PolyDeserialize
+ * accepts, in the same single pass but without building the polynomial.
+ * @param[in] source : bytes
+ * @param[in] length : number of bytes
+ * @return Are the bytes a correct representation?
+ */
+bool PolySerialCheck(const uint8_t *source, size_t length);
+
+#endif //POLYNOMIALS_POLY_SERIAL_H
@@ -0,0 +1,26 @@
+/** @file
+  Attributes compiling loops of polynomial operations for vector extensions.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_SIMD_H
+#define POLYNOMIALS_POLY_SIMD_H
+
+/*
+ * Marked functions are compiled for the default target and for a vector one,
+ * and the variant is chosen at run time. Other compilers get a single variant.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+/** Compiles a function for AVX2 as well. */
+#define POLY_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+/** Compiles a function for AVX2 with fused multiply-add as well. */
+#define POLY_FMA_CLONES __attribute__((target_clones("arch=haswell", "default")))
+#else
+#define POLY_SIMD_CLONES
+#define POLY_FMA_CLONES
+#endif
+
+#endif //POLYNOMIALS_POLY_SIMD_H
@@ -6,8 +6,11 @@
   @date 2021
 */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "poly_stack.h"
 #include <stdlib.h>
+#include <sys/mman.h>
 
 #define CHECK_NULL_PTR(p) if (!p) exit(1)
 
@@ -15,6 +18,11 @@ void StackInitialize(PolyStack* stack) {
     stack->size = 0;
     stack->capacity = 1;
     stack->content = NULL;
+    stack->programs = NULL;
+    stack->exprs = NULL;
+    stack->lazy = false;
+    stack->snapshot = NULL;
+    stack->snapshotSize = 0;
 }
 
 void PushPoly(PolyStack* stack, Poly p) {
@@ -22,31 +30,148 @@ void PushPoly(PolyStack* stack, Poly p) {
         stack->capacity = 2 * stack->capacity + 1;
         stack->content = realloc(stack->content, stack->capacity * sizeof(Poly));
         CHECK_NULL_PTR(stack->content);
+        stack->programs = realloc(stack->programs, stack->capacity * sizeof(PolyProgram*));
+        CHECK_NULL_PTR(stack->programs);
+        stack->exprs = realloc(stack->exprs, stack->capacity * sizeof(PolyExpr*));
+        CHECK_NULL_PTR(stack->exprs);
     }
 
+    stack->programs[stack->size] = NULL;
+    stack->exprs[stack->size] = NULL;
     stack->content[stack->size++] = p;
 }
 
+void PushExpr(PolyStack* stack, PolyExpr* e) {
+    PushPoly(stack, PolyZero());
+    stack->exprs[stack->size - 1] = e;
+}
+
+/**
+ * Materializes an entry of a stack. An expression which is not shared
+ * is replaced by its poly.
+ * @param[in] stack : stack
+ * @param[in] entryID : index of the entry
+ */
+static void StackForceEntry(PolyStack* stack, size_t entryID) {
+    PolyExpr* e = stack->exprs[entryID];
+    if (!e)
+        return;
+
+    if (e->refCount == 1) {
+        stack->content[entryID] = ExprTake(e);
+        stack->exprs[entryID] = NULL;
+    } else {
+        stack->content[entryID] = *ExprForce(e);
+    }
+}
+
+void StackForce(PolyStack* stack, size_t count) {
+    assert(stack->size >= count);
+    StackForceRange(stack, stack->size - count, count);
+}
+
+void StackForceRange(PolyStack* stack, size_t first, size_t count) {
+    assert(first <= stack->size && stack->size - first >= count);
+
+    for (size_t entryID = first; entryID < first + count; entryID++)
+        StackForceEntry(stack, entryID);
+}
+
 Poly TopPoly(PolyStack* stack) {
     assert(stack->size > 0);
+
+    StackForceEntry(stack, stack->size - 1);
     return stack->content[stack->size - 1];
 }
 
-Poly PopPoly(PolyStack* stack) {
+const PolyProgram* TopProgram(PolyStack* stack) {
+    assert(stack->size > 0);
+
+    PolyProgram** program = &stack->programs[stack->size - 1];
+    if (!*program) {
+        *program = malloc(sizeof(PolyProgram));
+        CHECK_NULL_PTR(*program);
+
+        Poly top = TopPoly(stack);
+        **program = PolyCompileEvaluator(&top);
+    }
+
+    return *program;
+}
+
+/**
+ * Clears a compiled evaluator of a top poly, if there is one.
+ * @param[in] stack : stack
+ */
+static void TopProgramDestroy(PolyStack* stack) {
+    PolyProgram* program = stack->programs[stack->size - 1];
+
+    if (program) {
+        ProgramDestroy(program);
+        free(program);
+    }
+}
+
+PolyExpr* PopExpr(PolyStack* stack) {
     assert(stack->size > 0);
 
-    Poly top = TopPoly(stack);
+    PolyExpr* top = stack->exprs[stack->size - 1];
+    if (!top)
+        top = ExprFromPoly(stack->content[stack->size - 1]);
+
+    TopProgramDestroy(stack);
     stack->size--;
 
     return top;
 }
 
+void StackShareTop(PolyStack* stack) {
+    assert(stack->size > 0);
+
+    PolyExpr** top = &stack->exprs[stack->size - 1];
+    if (!*top)
+        *top = ExprFromPoly(stack->content[stack->size - 1]);
+
+    PushExpr(stack, ExprShare(stack->exprs[stack->size - 1]));
+}
+
+Poly PopPoly(PolyStack* stack) {
+    assert(stack->size > 0);
+
+    PolyExpr* top = stack->exprs[stack->size - 1];
+    Poly topPoly = (top ? ExprTake(top) : stack->content[stack->size - 1]);
+
+    TopProgramDestroy(stack);
+    stack->size--;
+
+    return topPoly;
+}
+
 void StackDestroy(PolyStack* stack) {
     while (stack->size > 0) {
-        Poly top = stack->content[stack->size - 1];
-        PolyDestroy(&top);
+        PolyExpr* top = stack->exprs[stack->size - 1];
+
+        if (top)
+            ExprRelease(top);
+        else
+            PolyDestroy(&stack->content[stack->size - 1]);
+
+        TopProgramDestroy(stack);
         stack->size--;
     }
 
     free(stack->content);
-}
\ No newline at end of file
+    free(stack->programs);
+    free(stack->exprs);
+
+    /* Entries, which could refer to the mapping, are already released */
+    if (stack->snapshot)
+        munmap(stack->snapshot, stack->snapshotSize);
+}
+
+void StackAdoptSnapshot(PolyStack* stack, void* snapshot, size_t size) {
+    assert(!stack->snapshot);
+
+    stack->snapshot = snapshot;
+    stack->snapshotSize = size;
+}
@@ -10,12 +10,23 @@
 #define POLYNOMIALS_POLY_STACK_H
 
 #include "poly.h"
+#include "poly_eval.h"
+#include "poly_expr.h"
 
-/** Type representing a poly stack. */
+/**
+ * Type representing a poly stack. An entry may be a lazy expression, which
+ * is materialized when its poly is requested. A poly of an expression shared
+ * with other entries stays owned by the expression.
+ */
 typedef struct PolyStack {
-    size_t size;
-    size_t capacity;
-    Poly*  content;
+    size_t        size;
+    size_t        capacity;
+    Poly*         content;
+    PolyProgram** programs;     ///< compiled evaluators of polys, NULL until requested
+    PolyExpr**    exprs;        ///< expressions of entries, NULL for materialized ones
+    bool          lazy;         ///< are arithmetic operations deferred?
+    void*         snapshot;     ///< mapping of a restored checkpoint, NULL if there is none
+    size_t        snapshotSize; ///< number of bytes of @p snapshot
 } PolyStack;
 
 
@@ -32,6 +43,45 @@ void StackInitialize(PolyStack* stack);
  */
 void PushPoly(PolyStack* stack, Poly p);
 
+/**
+ * Pushes an expression to a stack. Takes the reference to @p e.
+ * @param[in] stack : stack
+ * @param[in] e : expression
+ */
+void PushExpr(PolyStack* stack, PolyExpr* e);
+
+/**
+ * Returns a top entry as an expression and removes it from stack.
+ * @param[in] stack : stack
+ * @return expression from top
+ */
+PolyExpr* PopExpr(PolyStack* stack);
+
+/**
+ * Pushes a reference to a top expression to a stack, so that both
+ * entries share its value.
+ * @param[in] stack : stack
+ */
+void StackShareTop(PolyStack* stack);
+
+/**
+ * Materializes @p count top entries of a stack, so that their polys
+ * may be read from @p stack->content.
+ * @param[in] stack : stack
+ * @param[in] count : number of entries
+ */
+void StackForce(PolyStack* stack, size_t count);
+
+/**
+ * Materializes @p count entries of a stack, starting from the one of index
+ * @p first counted from the bottom, so that their polys may be read from
+ * @p stack->content. Other entries are not touched.
+ * @param[in] stack : stack
+ * @param[in] first : index of the first entry
+ * @param[in] count : number of entries
+ */
+void StackForceRange(PolyStack* stack, size_t first, size_t count);
+
 /**
  * Returns a plain copy of a top poly from a stack
  * @param[in] stack : stack
@@ -39,6 +89,14 @@ void PushPoly(PolyStack* stack, Poly p);
  */
 Poly TopPoly(PolyStack* stack);
 
+/**
+ * Returns a compiled evaluator of a top poly. It is compiled at the first
+ * call and kept until the poly is removed from the stack.
+ * @param[in] stack : stack
+ * @return Program evaluating polynomial from top
+ */
+const PolyProgram* TopProgram(PolyStack* stack);
+
 /**
  * Returns a top poly and removes it from stack without deleting.
  * @param[in] stack : stack
@@ -46,6 +104,15 @@ Poly TopPoly(PolyStack* stack);
  */
 Poly PopPoly(PolyStack* stack);
 
+/**
+ * Hands a mapping, which serialized entries of a stack refer to, over to the stack.
+ * The mapping is released with the stack.
+ * @param[in] stack : stack without a mapping
+ * @param[in] snapshot : mapping
+ * @param[in] size : number of bytes of the mapping
+ */
+void StackAdoptSnapshot(PolyStack* stack, void* snapshot, size_t size);
+
 /**
  * Clears allocated for a stack memory.
  * @param[in] stack : stack
@@ -0,0 +1,478 @@
+/** @file
+  Implementation of flat exponent-vector representation of polynomials.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "poly_terms.h"
+
+#define CHECK_NULL_PTR(p) if (!p) exit(1)
+
+/** Minimal number of term products for which reordering variables pays off. */
+#define REORDER_MIN_WORK 4096
+
+void TermsInitialize(PolyTerms* terms, size_t vars) {
+    terms->count = 0;
+    terms->capacity = 0;
+    terms->vars = vars;
+    terms->coeffs = NULL;
+    terms->exps = NULL;
+}
+
+/**
+ * Returns the exponent vector of a term.
+ * @param[in] terms : list of terms
+ * @param[in] termID : index of the term
+ * @return exponent vector
+ */
+static inline poly_exp_t* TermExps(const PolyTerms* terms, size_t termID) {
+    return &terms->exps[termID * terms->vars];
+}
+
+void TermsAppend(PolyTerms* terms, poly_coeff_t coeff, const poly_exp_t exps[]) {
+    if (terms->count == terms->capacity) {
+        terms->capacity = 2 * terms->capacity + 1;
+        terms->coeffs = realloc(terms->coeffs, terms->capacity * sizeof(poly_coeff_t));
+        CHECK_NULL_PTR(terms->coeffs);
+
+        if (terms->vars > 0) {
+            terms->exps = realloc(terms->exps, terms->capacity * terms->vars * sizeof(poly_exp_t));
+            CHECK_NULL_PTR(terms->exps);
+        }
+    }
+
+    terms->coeffs[terms->count] = coeff;
+    if (terms->vars > 0)
+        memcpy(TermExps(terms, terms->count), exps, terms->vars * sizeof(poly_exp_t));
+    terms->count++;
+}
+
+void TermsWiden(PolyTerms* terms, size_t vars) {
+    if (vars <= terms->vars)
+        return;
+
+    if (terms->capacity > 0) {
+        terms->exps = realloc(terms->exps, terms->capacity * vars * sizeof(poly_exp_t));
+        CHECK_NULL_PTR(terms->exps);
+    }
+
+    /* Vectors are moved from the last one, so none is overwritten before it is moved */
+    for (size_t termID = terms->count; termID-- > 0;) {
+        poly_exp_t* widened = &terms->exps[termID * vars];
+
+        memmove(widened, TermExps(terms, termID), terms->vars * sizeof(poly_exp_t));
+        memset(&widened[terms->vars], 0, (vars - terms->vars) * sizeof(poly_exp_t));
+    }
+
+    terms->vars = vars;
+}
+
+void TermsDestroy(PolyTerms* terms) {
+    free(terms->coeffs);
+    free(terms->exps);
+    TermsInitialize(terms, terms->vars);
+}
+
+size_t PolyVarCount(const Poly* p) {
+    if (PolyIsCoeff(p))
+        return 0;
+
+    size_t maxMonoVars = 0;
+
+    for (size_t curMonoID = 0; curMonoID < p->size; curMonoID++) {
+        size_t curVars = PolyVarCount(MonoGetPoly(&p->arr[curMonoID]));
+
+        if (curVars > maxMonoVars)
+            maxMonoVars = curVars;
+    }
+
+    return maxMonoVars + 1;
+}
+
+/**
+ * Appends terms of @p p to @p terms, where @p path holds exponents
+ * of the variables with indexes lower than @p level.
+ * @param[in] p : poly of variables starting from @f$x_{level}@f$
+ * @param[in] level : index of the main variable of @p p
+ * @param[in] path : exponent vector of the current term
+ * @param[in] terms : destination list
+ */
+static void PolyToTermsFrom(const Poly* p, size_t level, poly_exp_t path[], PolyTerms* terms) {
+    if (PolyIsCoeff(p)) {
+        if (!PolyIsZero(p))
+            TermsAppend(terms, p->coeff, path);
+        return;
+    }
+
+    assert(level < terms->vars);
+
+    for (size_t curMonoID = 0; curMonoID < p->size; curMonoID++) {
+        path[level] = MonoGetExp(&p->arr[curMonoID]);
+        PolyToTermsFrom(MonoGetPoly(&p->arr[curMonoID]), level + 1, path, terms);
+    }
+
+    path[level] = 0;
+}
+
+void PolyToTerms(const Poly* p, PolyTerms* terms) {
+    poly_exp_t* path = calloc(terms->vars + 1, sizeof(poly_exp_t));
+    CHECK_NULL_PTR(path);
+
+    PolyToTermsFrom(p, 0, path, terms);
+
+    free(path);
+}
+
+/**
+ * Compares exponent vectors of two terms lexicographically.
+ * @param[in] terms : list of terms
+ * @param[in] firstID : index of the first term
+ * @param[in] secondID : index of the second term
+ * @return negative, zero or positive value as in strcmp
+ */
+static int TermsCompare(const PolyTerms* terms, size_t firstID, size_t secondID) {
+    const poly_exp_t* first = TermExps(terms, firstID);
+    const poly_exp_t* second = TermExps(terms, secondID);
+
+    for (size_t var = 0; var < terms->vars; var++) {
+        if (first[var] != second[var])
+            return first[var] < second[var] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Sorts indexes of terms by their exponent vectors with a stable merge sort.
+ * @param[in] terms : list of terms
+ * @param[in] order : indexes to sort
+ * @param[in] buffer : auxiliary array of the same length as @p order
+ */
+static void TermsSortOrder(const PolyTerms* terms, size_t order[], size_t buffer[]) {
+    for (size_t width = 1; width < terms->count; width *= 2) {
+        for (size_t lo = 0; lo < terms->count; lo += 2 * width) {
+            size_t mid = lo + width < terms->count ? lo + width : terms->count;
+            size_t hi = mid + width < terms->count ? mid + width : terms->count;
+            size_t left = lo, right = mid, resID = lo;
+
+            while (left < mid && right < hi) {
+                if (TermsCompare(terms, order[right], order[left]) < 0)
+                    buffer[resID++] = order[right++];
+                else
+                    buffer[resID++] = order[left++];
+            }
+
+            while (left < mid)
+                buffer[resID++] = order[left++];
+            while (right < hi)
+                buffer[resID++] = order[right++];
+        }
+
+        memcpy(order, buffer, terms->count * sizeof(size_t));
+    }
+}
+
+/**
+ * Builds a poly from sorted terms with indexes @p order[lo, hi), all of which
+ * share exponents of the variables with indexes lower than @p level.
+ * @param[in] terms : list of terms
+ * @param[in] order : sorted indexes of terms
+ * @param[in] lo : including start
+ * @param[in] hi : excluding end
+ * @param[in] level : index of the main variable of the result
+ * @return poly of variables starting from @f$x_{level}@f$
+ */
+static Poly PolyFromSortedTerms(const PolyTerms* terms, const size_t order[],
+                                size_t lo, size_t hi, size_t level) {
+    if (level == terms->vars) {
+        poly_coeff_t coeffSum = 0;
+        for (size_t termID = lo; termID < hi; termID++)
+            coeffSum += terms->coeffs[order[termID]];
+        return PolyFromCoeff(coeffSum);
+    }
+
+    size_t resMonoID = 0;
+    Mono* monos = malloc((hi - lo) * sizeof(Mono));
+    CHECK_NULL_PTR(monos);
+
+    for (size_t groupStart = lo, groupEnd; groupStart < hi; groupStart = groupEnd) {
+        poly_exp_t curExp = TermExps(terms, order[groupStart])[level];
+
+        for (groupEnd = groupStart + 1; groupEnd < hi; groupEnd++) {
+            if (TermExps(terms, order[groupEnd])[level] != curExp)
+                break;
+        }
+
+        Poly coeffPoly = PolyFromSortedTerms(terms, order, groupStart, groupEnd, level + 1);
+        if (!PolyIsZero(&coeffPoly))
+            monos[resMonoID++] = MonoFromPoly(&coeffPoly, curExp);
+    }
+
+    /* Same reduction as for the minimal form of the other operations */
+    if (resMonoID == 0 || (resMonoID == 1 && MonoGetExp(&monos[0]) == 0
+                           && PolyIsCoeff(MonoGetPoly(&monos[0])))) {
+        Poly resPoly = (resMonoID == 0 ? PolyZero() : *MonoGetPoly(&monos[0]));
+        free(monos);
+        return resPoly;
+    }
+
+    Mono* shrunk = realloc(monos, resMonoID * sizeof(Mono));
+    CHECK_NULL_PTR(shrunk);
+
+    return (Poly) {.size = resMonoID, .arr = shrunk};
+}
+
+Poly PolyFromTerms(PolyTerms* terms) {
+    if (terms->count == 0)
+        return PolyZero();
+
+    size_t* order = malloc(2 * terms->count * sizeof(size_t));
+    CHECK_NULL_PTR(order);
+
+    for (size_t termID = 0; termID < terms->count; termID++)
+        order[termID] = termID;
+
+    TermsSortOrder(terms, order, order + terms->count);
+    Poly resPoly = PolyFromSortedTerms(terms, order, 0, terms->count, 0);
+
+    free(order);
+
+    return resPoly;
+}
+
+/**
+ * Moves the exponent of variable @f$x_i@f$ to @f$x_{map[i]}@f$ in every term.
+ * @param[in] terms : list of terms
+ * @param[in] map : injective map of length @p terms->vars
+ * @param[in] renamed : destination list over variables with indexes lower than
+ *                      @p renamed->vars, which can be @p terms for permutations
+ */
+static void TermsRenameVars(PolyTerms* terms, const size_t map[], PolyTerms* renamed) {
+    poly_exp_t* exps = calloc(renamed->vars + 1, sizeof(poly_exp_t));
+    CHECK_NULL_PTR(exps);
+
+    for (size_t termID = 0; termID < terms->count; termID++) {
+        for (size_t var = 0; var < terms->vars; var++)
+            exps[map[var]] = TermExps(terms, termID)[var];
+
+        if (renamed == terms)
+            memcpy(TermExps(terms, termID), exps, terms->vars * sizeof(poly_exp_t));
+        else
+            TermsAppend(renamed, terms->coeffs[termID], exps);
+    }
+
+    free(exps);
+}
+
+/**
+ * Moves the exponent of variable @f$x_i@f$ to @f$x_{perm[i]}@f$ in every term.
+ * @param[in] terms : list of terms
+ * @param[in] perm : permutation of length @p terms->vars
+ */
+static void TermsPermuteVars(PolyTerms* terms, const size_t perm[]) {
+    TermsRenameVars(terms, perm, terms);
+}
+
+/**
+ * Extends a permutation of length @p n to @p vars variables with identity.
+ * @param[in] n : length of the permutation
+ * @param[in] perm : permutation
+ * @param[in] vars : length of the result
+ * @return extended permutation
+ */
+static size_t* PermutationExtend(size_t n, const size_t perm[], size_t vars) {
+    size_t* extended = malloc((vars + 1) * sizeof(size_t));
+    CHECK_NULL_PTR(extended);
+
+    for (size_t var = 0; var < vars; var++)
+        extended[var] = (var < n ? perm[var] : var);
+
+    return extended;
+}
+
+Poly PolyRenameVars(const Poly* p, size_t n, const size_t map[]) {
+    if (PolyIsCoeff(p))
+        return PolyClone(p);
+
+    size_t renamedVars = 0;
+    for (size_t var = 0; var < n; var++) {
+        if (map[var] + 1 > renamedVars)
+            renamedVars = map[var] + 1;
+    }
+
+    PolyTerms terms, renamed;
+    TermsInitialize(&terms, n);
+    TermsInitialize(&renamed, renamedVars);
+    PolyToTerms(p, &terms);
+    TermsRenameVars(&terms, map, &renamed);
+
+    Poly resPoly = PolyFromTerms(&renamed);
+
+    TermsDestroy(&terms);
+    TermsDestroy(&renamed);
+
+    return resPoly;
+}
+
+Poly PolyPermuteVars(const Poly* p, size_t n, const size_t perm[]) {
+    if (PolyIsCoeff(p))
+        return PolyClone(p);
+
+    size_t polyVars = PolyVarCount(p);
+    size_t vars = (n > polyVars ? n : polyVars);
+    size_t* extended = PermutationExtend(n, perm, vars);
+
+    Poly resPoly = PolyRenameVars(p, vars, extended);
+    free(extended);
+
+    return resPoly;
+}
+
+/**
+ * Comparator for sorting exponents in ascending order.
+ * @param[in] e1 : exponent @f$e_1@f$
+ * @param[in] e2 : exponent @f$e_2@f$
+ * @return sign of the difference of exponents
+ */
+static int ExpComparator(const void* e1, const void* e2) {
+    poly_exp_t first = *(const poly_exp_t*) e1, second = *(const poly_exp_t*) e2;
+    return (first > second) - (first < second);
+}
+
+/**
+ * Adds the numbers of distinct exponents of each variable in @p terms to @p distinct.
+ * @param[in] terms : list of terms
+ * @param[in] distinct : array of length @p terms->vars
+ */
+static void TermsCountDistinctExps(const PolyTerms* terms, size_t distinct[]) {
+    poly_exp_t* column = malloc((terms->count + 1) * sizeof(poly_exp_t));
+    CHECK_NULL_PTR(column);
+
+    for (size_t var = 0; var < terms->vars; var++) {
+        for (size_t termID = 0; termID < terms->count; termID++)
+            column[termID] = TermExps(terms, termID)[var];
+
+        qsort(column, terms->count, sizeof(poly_exp_t), ExpComparator);
+
+        for (size_t termID = 0; termID < terms->count; termID++) {
+            if (termID == 0 || column[termID] != column[termID - 1])
+                distinct[var]++;
+        }
+    }
+
+    free(column);
+}
+
+/**
+ * Chooses the nesting order of variables for a product of two polynomials.
+ * Variables with fewer distinct exponents become outer ones, since every
+ * distinct prefix of an exponent vector costs a separate node.
+ * @param[in] pTerms : terms of @f$p@f$
+ * @param[in] qTerms : terms of @f$q@f$
+ * @param[in] perm : destination for the permutation
+ * @return Does the permutation differ from identity?
+ */
+static bool ChooseVarOrder(const PolyTerms* pTerms, const PolyTerms* qTerms, size_t perm[]) {
+    size_t vars = pTerms->vars;
+    size_t* distinct = calloc(vars, sizeof(size_t));
+    size_t* order = malloc(vars * sizeof(size_t));
+    CHECK_NULL_PTR(distinct);
+    CHECK_NULL_PTR(order);
+
+    TermsCountDistinctExps(pTerms, distinct);
+    TermsCountDistinctExps(qTerms, distinct);
+
+    /* Stable insertion sort keeps the original order of equally good variables */
+    for (size_t var = 0; var < vars; var++) {
+        size_t pos = var;
+        for (; pos > 0 && distinct[order[pos - 1]] > distinct[var]; pos--)
+            order[pos] = order[pos - 1];
+        order[pos] = var;
+    }
+
+    bool isIdentity = true;
+    for (size_t pos = 0; pos < vars; pos++) {
+        perm[order[pos]] = pos;
+        isIdentity &= (order[pos] == pos);
+    }
+
+    free(distinct);
+    free(order);
+
+    return !isIdentity;
+}
+
+/**
+ * Counts non-zero terms of a poly without allocating memory.
+ * @param[in] p : poly
+ * @return number of terms
+ */
+static size_t PolyTermCount(const Poly* p) {
+    if (PolyIsCoeff(p))
+        return (PolyIsZero(p) ? 0 : 1);
+
+    size_t count = 0;
+    for (size_t curMonoID = 0; curMonoID < p->size; curMonoID++)
+        count += PolyTermCount(MonoGetPoly(&p->arr[curMonoID]));
+
+    return count;
+}
+
+Poly PolyMulReordered(const Poly* p, const Poly* q) {
+    size_t pVars = PolyVarCount(p), qVars = PolyVarCount(q);
+    size_t vars = (pVars > qVars ? pVars : qVars);
+
+    if (pVars == 0 || qVars == 0 || vars < 2)
+        return PolyMul(p, q);
+
+    /* Operands are flattened only for products, which are worth reordering */
+    size_t pCount = PolyTermCount(p), qCount = PolyTermCount(q);
+    if (pCount < 2 || qCount < 2 || pCount < REORDER_MIN_WORK / qCount)
+        return PolyMul(p, q);
+
+    PolyTerms pTerms, qTerms;
+    TermsInitialize(&pTerms, vars);
+    TermsInitialize(&qTerms, vars);
+    PolyToTerms(p, &pTerms);
+    PolyToTerms(q, &qTerms);
+
+    size_t* perm = malloc(vars * sizeof(size_t));
+    CHECK_NULL_PTR(perm);
+
+    Poly resPoly;
+
+    if (!ChooseVarOrder(&pTerms, &qTerms, perm)) {
+        resPoly = PolyMul(p, q);
+    } else {
+        TermsPermuteVars(&pTerms, perm);
+        TermsPermuteVars(&qTerms, perm);
+
+        Poly pReordered = PolyFromTerms(&pTerms);
+        Poly qReordered = PolyFromTerms(&qTerms);
+        Poly product = PolyMul(&pReordered, &qReordered);
+
+        /* Mapping the product back to the original order of variables */
+        size_t* inverse = malloc(vars * sizeof(size_t));
+        CHECK_NULL_PTR(inverse);
+        for (size_t var = 0; var < vars; var++)
+            inverse[perm[var]] = var;
+
+        resPoly = PolyPermuteVars(&product, vars, inverse);
+
+        PolyDestroy(&pReordered);
+        PolyDestroy(&qReordered);
+        PolyDestroy(&product);
+        free(inverse);
+    }
+
+    TermsDestroy(&pTerms);
+    TermsDestroy(&qTerms);
+    free(perm);
+
+    return resPoly;
+}
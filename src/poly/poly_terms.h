@@ -0,0 +1,108 @@
+/** @file
+  Interface of flat exponent-vector representation of polynomials.
+
+  @author Tymofii Vedmedenko
+  @copyright University of Warsaw
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_TERMS_H
+#define POLYNOMIALS_POLY_TERMS_H
+
+#include "poly.h"
+
+/**
+ * Type representing a list of terms @f$c x_0^{e_0} x_1^{e_1} \ldots@f$.
+ * Exponent vectors are stored row-major in @p exps, each of length @p vars.
+ */
+typedef struct PolyTerms {
+    size_t        count;    ///< number of terms
+    size_t        capacity; ///< number of terms which fit without reallocation
+    size_t        vars;     ///< length of each exponent vector
+    poly_coeff_t* coeffs;   ///< coefficients of terms
+    poly_exp_t*   exps;     ///< exponent vectors of terms
+} PolyTerms;
+
+/**
+ * Initializes an empty list of terms over @p vars variables.
+ * @param[in] terms : list to initialize
+ * @param[in] vars : length of exponent vectors
+ */
+void TermsInitialize(PolyTerms* terms, size_t vars);
+
+/**
+ * Appends a term to the list.
+ * @param[in] terms : list of terms
+ * @param[in] coeff : coefficient of the term
+ * @param[in] exps : exponent vector of length @p terms->vars
+ */
+void TermsAppend(PolyTerms* terms, poly_coeff_t coeff, const poly_exp_t exps[]);
+
+/**
+ * Lengthens exponent vectors of the list to @p vars variables, setting
+ * exponents of the new variables to zero. Shorter lengths are ignored.
+ * @param[in] terms : list of terms
+ * @param[in] vars : new length of exponent vectors
+ */
+void TermsWiden(PolyTerms* terms, size_t vars);
+
+/**
+ * Clears an allocated memory for a list of terms.
+ * @param[in] terms : list of terms
+ */
+void TermsDestroy(PolyTerms* terms);
+
+/**
+ * Counts the variables a poly depends on, i.e. its nesting depth.
+ * @param[in] p : poly
+ * @return number of variables
+ */
+size_t PolyVarCount(const Poly* p);
+
+/**
+ * Appends all non-zero terms of @p p to @p terms. The list has to
+ * be initialized with at least PolyVarCount(@p p) variables.
+ * @param[in] p : poly
+ * @param[in] terms : destination list
+ */
+void PolyToTerms(const Poly* p, PolyTerms* terms);
+
+/**
+ * Builds a poly from a list of terms in any order. Terms with equal
+ * exponent vectors are summed up. Terms are sorted through an array
+ * of their indexes, so the list itself is not changed.
+ * @param[in] terms : list of terms
+ * @return poly as a sum of the terms
+ */
+Poly PolyFromTerms(PolyTerms* terms);
+
+/**
+ * Renames variables of a poly, so that @f$x_i@f$ becomes @f$x_{perm[i]}@f$
+ * for @f$i < n@f$. Variables with greater indexes are not changed.
+ * @param[in] p : poly
+ * @param[in] n : length of the permutation
+ * @param[in] perm : permutation of @f$\{0, \ldots, n - 1\}@f$
+ * @return @p p with permuted variables
+ */
+Poly PolyPermuteVars(const Poly* p, size_t n, const size_t perm[]);
+
+/**
+ * Renames variables of a poly, so that @f$x_i@f$ becomes @f$x_{map[i]}@f$.
+ * @param[in] p : poly
+ * @param[in] n : length of the map, at least PolyVarCount(@p p)
+ * @param[in] map : injective map of variable indexes
+ * @return @p p with renamed variables
+ */
+Poly PolyRenameVars(const Poly* p, size_t n, const size_t map[]);
+
+/**
+ * Multiplies two polynomials, nesting the variables in the order which
+ * minimizes the number of nodes of the operands. The product is mapped
+ * back to the original order of variables.
+ * @param[in] p : poly @f$p@f$
+ * @param[in] q : poly @f$q@f$
+ * @return @f$p * q@f$
+ */
+Poly PolyMulReordered(const Poly* p, const Poly* q);
+
+#endif //POLYNOMIALS_POLY_TERMS_H
@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
@@ -11,6 +12,11 @@
 #include <string.h>
 
 #include "poly_data.h"
+#include "../src/poly/poly_terms.h"
+#include "../src/poly/poly_parallel.h"
+#include "../src/poly/poly_eval.h"
+#include "../src/poly/poly_expr.h"
+#include "../src/poly/poly_serial.h"
 
 #define CHECK_PTR(p)  \
   do {                \
@@ -315,6 +321,8 @@ static bool SimpleAtTest(void) {
 static bool OverflowTest(void) {
     bool res = true;
     res &= TestMul(P(C(1L << 32), 1), C(1L << 32), C(0));
+    res &= TestMul(P(C(1L << 32), 1, C(1L << 32), 100), P(C(1L << 32), 1, C(1L << 32), 200), C(0));
+    res &= TestMul(P(P(C(1L << 32), 1), 1), P(P(C(1L << 32), 1), 1), C(0));
     res &= TestAt(P(C(1), 64), 2, C(0));
     res &= TestAt(P(C(1), 0, C(1), 64), 2, C(1));
     res &= TestAt(P(P(C(1), 1), 64), 2, C(0));
@@ -1186,6 +1194,725 @@ static bool PolyCloneTest(void) {
     return res;
 }
 
+/**
+ * Tests correctness of "PolyPermuteVars" and "PolyMulReordered".
+ */
+static bool PermuteTest(void) {
+    /* p(x0, x1, x2) = 2 + 3x0^2 x1 + 5x1^4 x2^3 */
+    Poly p = P(P(C(2), 0, P(C(5), 3), 4), 0, P(C(3), 1), 2);
+    size_t perm[] = {2, 0, 1};
+
+    Poly received = PolyPermuteVars(&p, 3, perm);
+    Poly expected = P(C(2), 0, P(P(C(3), 2), 0), 1, P(C(5), 3), 4);
+    bool res = PolyIsEq(&received, &expected);
+
+    size_t inverse[] = {1, 2, 0};
+    Poly restored = PolyPermuteVars(&received, 3, inverse);
+    res &= PolyIsEq(&restored, &p);
+
+    Poly plain = PolyMul(&p, &received);
+    Poly reordered = PolyMulReordered(&p, &received);
+    res &= PolyIsEq(&plain, &reordered);
+
+    /* Operands with many exponents of x0 and few of x1 are multiplied with x1 outermost */
+    PolyTerms wideTerms, tallTerms;
+    TermsInitialize(&wideTerms, 2);
+    TermsInitialize(&tallTerms, 2);
+    for (poly_exp_t i = 0; i < 100; i++) {
+        for (poly_exp_t j = 0; j < 3; j++) {
+            poly_exp_t exps[] = {i, j};
+            if (j < 2)
+                TermsAppend(&wideTerms, i + j + 1, exps);
+            if (i < 50)
+                TermsAppend(&tallTerms, i * j - 1, exps);
+        }
+    }
+
+    Poly wide = PolyFromTerms(&wideTerms);
+    Poly tall = PolyFromTerms(&tallTerms);
+    Poly widePlain = PolyMul(&wide, &tall);
+    Poly wideReordered = PolyMulReordered(&wide, &tall);
+    res &= PolyIsEq(&widePlain, &wideReordered);
+
+    TermsDestroy(&wideTerms);
+    TermsDestroy(&tallTerms);
+    PolyDestroy(&wide);
+    PolyDestroy(&tall);
+    PolyDestroy(&widePlain);
+    PolyDestroy(&wideReordered);
+
+    PolyDestroy(&p);
+    PolyDestroy(&received);
+    PolyDestroy(&expected);
+    PolyDestroy(&restored);
+    PolyDestroy(&plain);
+    PolyDestroy(&reordered);
+
+    return res;
+}
+
+/**
+ * Tests "PolyMul" and "PolyCompose" on polynomials with monomial content
+ * and exponents divisible by a common step.
+ */
+static bool DeflatedMulTest(void) {
+    bool res = true;
+
+    res &= TestMul(P(C(1), 100, C(2), 104), P(C(3), 2, C(-1), 6),
+                   P(C(3), 102, C(5), 106, C(-2), 110));
+    res &= TestMul(P(C(2), 3), P(C(1), 0, P(C(1), 1), 5),
+                   P(C(2), 3, P(C(2), 1), 8));
+    res &= TestMul(P(P(C(1), 100, C(2), 104), 10, C(1), 14), P(P(C(3), 2, C(-1), 6), 2, C(-1), 6),
+                   P(P(C(3), 102, C(5), 106, C(-2), 110), 12,
+                     P(C(3), 2, C(-1), 6, C(-1), 100, C(-2), 104), 16, C(-1), 20));
+    res &= TestMul(P(C(1), 0, P(C(1), 1), 2), P(C(1), 0, P(C(-1), 1), 2),
+                   P(C(1), 0, P(C(-1), 2), 4));
+
+    Poly p = P(C(1), 3);
+    Poly q[] = {P(C(1), 100, C(1), 104)};
+    Poly received = PolyCompose(&p, 1, q);
+    Poly expected = P(C(1), 300, C(3), 304, C(3), 308, C(1), 312);
+
+    res &= PolyIsEq(&received, &expected);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q[0]);
+    PolyDestroy(&received);
+    PolyDestroy(&expected);
+
+    return res;
+}
+
+/**
+ * Compares "PolyCompose" of @p p with @p k polynomials @p q to @p expected.
+ */
+static bool TestCompose(Poly p, size_t k, Poly q[], Poly expected) {
+    Poly received = PolyCompose(&p, k, q);
+    bool res = PolyIsEq(&received, &expected);
+
+    PolyDestroy(&p);
+    PolyDestroy(&received);
+    PolyDestroy(&expected);
+
+    for (size_t i = 0; i < k; i++)
+        PolyDestroy(&q[i]);
+
+    return res;
+}
+
+/**
+ * Tests "PolyCompose" with constant, single-monomial and single-variable inner polynomials.
+ */
+static bool ComposeShapeTest(void) {
+    bool res = true;
+
+    /* p(x0, x1) = x0 x1 + 2 x0^2 */
+    Poly constQ[] = {C(3)};
+    res &= TestCompose(P(P(C(1), 1), 1, C(2), 2), 1, constQ, C(18));
+
+    Poly varQ[] = {P(P(C(1), 1), 0), P(C(1), 1)};
+    res &= TestCompose(P(P(C(1), 1), 1, C(2), 2), 2, varQ,
+                       P(P(C(2), 2), 0, P(C(1), 1), 1));
+
+    Poly monoQ[] = {P(C(2), 3), C(5)};
+    res &= TestCompose(P(P(C(1), 1), 1, C(2), 2), 2, monoQ, P(C(10), 3, C(8), 6));
+
+    return res;
+}
+
+/**
+ * Tests whether "PolyCompose" gives the same result for different numbers of threads.
+ */
+static bool ParallelComposeTest(void) {
+    Poly p = P(P(C(1), 1, C(-1), 3), 1, C(2), 2, C(3), 3, P(C(4), 2), 4, C(5), 5, C(6), 9);
+    Poly q[] = {P(C(1), 0, C(1), 1), P(C(2), 2)};
+
+    ParallelSetThreadCount(1);
+    Poly sequential = PolyCompose(&p, 2, q);
+
+    bool res = true;
+
+    for (size_t threads = 2; threads <= 4; threads++) {
+        ParallelSetThreadCount(threads);
+        Poly parallel = PolyCompose(&p, 2, q);
+        res &= PolyIsEq(&sequential, &parallel);
+        PolyDestroy(&parallel);
+    }
+
+    /* A level large enough to be split between threads, with coefficients composed inside the tasks */
+    const size_t bigSize = 5000;
+    Mono* monos = malloc(bigSize * sizeof(Mono));
+    CHECK_PTR(monos);
+    for (size_t monoID = 0; monoID < bigSize; monoID++)
+        monos[monoID] = M(P(C((poly_coeff_t) monoID + 1), 1, C(1), 2), (poly_exp_t) monoID);
+
+    Poly big = PolyAddMonos(bigSize, monos);
+    free(monos);
+    Poly bigQ[] = {P(P(C(1), 1), 0), P(C(3), 2)};
+
+    ParallelSetThreadCount(1);
+    Poly bigSequential = PolyCompose(&big, 2, bigQ);
+
+    for (size_t threads = 2; threads <= 4; threads++) {
+        ParallelSetThreadCount(threads);
+        Poly parallel = PolyCompose(&big, 2, bigQ);
+        res &= PolyIsEq(&bigSequential, &parallel);
+        PolyDestroy(&parallel);
+    }
+
+    ParallelSetThreadCount(0);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q[0]);
+    PolyDestroy(&q[1]);
+    PolyDestroy(&sequential);
+    PolyDestroy(&big);
+    PolyDestroy(&bigQ[0]);
+    PolyDestroy(&bigQ[1]);
+    PolyDestroy(&bigSequential);
+
+    return res;
+}
+
+/**
+ * Tests correctness of "PolyEvalPoint".
+ */
+static bool EvalPointTest(void) {
+    /* p(x0, x1, x2) = 2 + 3x0^2 x1 - x0^5 + 5x1^4 x2^3 */
+    Poly p = P(P(C(2), 0, P(C(5), 3), 4), 0, P(C(3), 1), 2, C(-1), 5);
+    poly_coeff_t point[] = {2, -1, 3};
+
+    bool res = PolyEvalPoint(&p, 3, point) == 2 - 12 - 32 + 135;
+    res &= PolyEvalPoint(&p, 2, point) == 2 - 12 - 32;
+    res &= PolyEvalPoint(&p, 0, point) == 2;
+
+    for (poly_coeff_t x = -3; x <= 3; x++) {
+        Poly at = PolyAt(&p, x);
+        poly_coeff_t rest[] = {-1, 3};
+        res &= PolyEvalPoint(&at, 2, rest) == PolyEvalPoint(&p, 3, (poly_coeff_t[]) {x, -1, 3});
+        PolyDestroy(&at);
+    }
+
+    PolyDestroy(&p);
+
+    return res;
+}
+
+/**
+ * Tests if "PolyEvalPoints" agrees with "PolyEvalPoint", also for a number
+ * of points which is not a multiple of the lane count.
+ */
+static bool EvalPointsTest(void) {
+    Poly p = P(P(C(2), 0, P(C(5), 3), 4), 0, P(C(3), 1), 2, C(-1), 5);
+    /* More points than a single task of a thread evaluates, so that tasks are shared */
+    const size_t n = 3, count = 3 * 4096 + 1003;
+    poly_coeff_t* points = malloc(n * count * sizeof(poly_coeff_t));
+    poly_coeff_t* values = malloc(count * sizeof(poly_coeff_t));
+    CHECK_PTR(points);
+    CHECK_PTR(values);
+
+    for (size_t i = 0; i < n * count; i++)
+        points[i] = (poly_coeff_t) (i * 7919 % 61) - 30;
+
+    bool res = true;
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        ParallelSetThreadCount(threads);
+        PolyEvalPoints(&p, n, count, points, values);
+
+        for (size_t i = 0; i < count; i++)
+            res &= values[i] == PolyEvalPoint(&p, n, &points[i * n]);
+    }
+    ParallelSetThreadCount(0);
+
+    PolyDestroy(&p);
+    free(points);
+    free(values);
+
+    return res;
+}
+
+/**
+ * Tests if programs compiled by "PolyCompileEvaluator" agree with "PolyEvalPoint",
+ * also for a program whose power table does not fit on the stack.
+ */
+static bool CompiledEvalTest(void) {
+    Poly polys[4] = {
+            C(-7),
+            P(P(C(2), 0, P(C(5), 3), 4), 0, P(C(3), 1), 2, C(-1), 5),
+            P(P(C(1), 2, P(C(4), 0, C(-2), 3), 7), 1, C(6), 3),
+            PolyZero()
+    };
+
+    /* polys[3] = sum of x0^i x1^(2i) for i < 100 */
+    for (poly_exp_t i = 0; i < 100; i++) {
+        Poly term = P(P(C(1), 2 * i), i);
+        Poly sum = PolyAdd(&polys[3], &term);
+        PolyDestroy(&polys[3]);
+        PolyDestroy(&term);
+        polys[3] = sum;
+    }
+
+    poly_coeff_t points[5][3] = {{2, -1, 3}, {0, 5, -2}, {-3, 0, 0}, {1, 1, 1}, {7, -4, 11}};
+    bool res = true;
+
+    for (size_t polyID = 0; polyID < 4; polyID++) {
+        PolyProgram program = PolyCompileEvaluator(&polys[polyID]);
+
+        for (size_t pointID = 0; pointID < 5; pointID++) {
+            for (size_t n = 0; n <= 3; n++) {
+                res &= ProgramEvalPoint(&program, n, points[pointID]) ==
+                       PolyEvalPoint(&polys[polyID], n, points[pointID]);
+            }
+        }
+
+        ProgramDestroy(&program);
+        PolyDestroy(&polys[polyID]);
+    }
+
+    return res;
+}
+
+/**
+ * Tests "PolyAt" for the values with fast paths, cancellation of terms
+ * and powers overflowing to zero.
+ */
+static bool AtSpecialValuesTest(void) {
+    /* p(x0, x1) = 1 + x1 + x0 (2 - x1) + x0^2 x1 + 5 x0^64 */
+    Poly p = P(P(C(1), 0, C(1), 1), 0, P(C(2), 0, C(-1), 1), 1, P(C(1), 1), 2, C(5), 64);
+    bool res = true;
+
+    Poly at = PolyAt(&p, 0);
+    Poly expected = P(C(1), 0, C(1), 1);
+    res &= PolyIsEq(&at, &expected);
+    PolyDestroy(&at);
+    PolyDestroy(&expected);
+
+    at = PolyAt(&p, 1);
+    expected = P(C(8), 0, C(1), 1);
+    res &= PolyIsEq(&at, &expected);
+    PolyDestroy(&at);
+    PolyDestroy(&expected);
+
+    at = PolyAt(&p, -1);
+    expected = P(C(4), 0, C(3), 1);
+    res &= PolyIsEq(&at, &expected);
+    PolyDestroy(&at);
+    PolyDestroy(&expected);
+
+    /* 2^64 overflows to zero */
+    at = PolyAt(&p, 2);
+    expected = P(C(5), 0, C(3), 1);
+    res &= PolyIsEq(&at, &expected);
+    PolyDestroy(&at);
+    PolyDestroy(&expected);
+
+    PolyDestroy(&p);
+
+    /* q(x0, x1) = x1 - x0 x1 vanishes at x0 = 1 */
+    Poly q = P(P(C(1), 1), 0, P(C(-1), 1), 1);
+    at = PolyAt(&q, 1);
+    res &= PolyIsZero(&at);
+    PolyDestroy(&at);
+    PolyDestroy(&q);
+
+    return res;
+}
+
+/**
+ * Tests "PolyEvalDouble" against exact values and compensated Horner's scheme
+ * against cancellation, which the plain scheme does not survive.
+ */
+static bool EvalDoubleTest(void) {
+    /* p(x0, x1, x2) = 2 + 3x0^2 x1 - x0^5 + 5x1^4 x2^3 */
+    Poly p = P(P(C(2), 0, P(C(5), 3), 4), 0, P(C(3), 1), 2, C(-1), 5);
+    double point[] = {2, -1, 3};
+
+    bool res = PolyEvalDouble(&p, 3, point, false) == 2 - 12 - 32 + 135;
+    res &= PolyEvalDouble(&p, 3, point, true) == 2 - 12 - 32 + 135;
+    res &= PolyEvalDouble(&p, 1, point, true) == 2 - 32;
+
+    double points[3 * 21], values[21];
+    for (size_t i = 0; i < 21; i++) {
+        points[3 * i] = 0.25 * (double) i - 2;
+        points[3 * i + 1] = -0.5;
+        points[3 * i + 2] = 1.5;
+    }
+
+    for (int compensated = 0; compensated <= 1; compensated++) {
+        PolyEvalDoublePoints(&p, 3, 21, points, values, compensated);
+        for (size_t i = 0; i < 21; i++)
+            res &= values[i] == PolyEvalDouble(&p, 3, &points[3 * i], compensated);
+    }
+
+    PolyDestroy(&p);
+
+    /* q(x0) = (x0 - 1)^7 expanded, evaluated near its root */
+    Poly q = P(C(-1), 0, C(7), 1, C(-21), 2, C(35), 3, C(-35), 4, C(21), 5, C(-7), 6, C(1), 7);
+    double nearRoot[] = {1.0009765625};
+    double exact = ldexp(1, -70);
+
+    res &= fabs(PolyEvalDouble(&q, 1, nearRoot, true) - exact) < 1e-6 * exact;
+    res &= fabs(PolyEvalDouble(&q, 1, nearRoot, false) - exact) > exact;
+
+    PolyDestroy(&q);
+
+    return res;
+}
+
+/**
+ * Tests "PolyCheckMul" and "PolyCheckCompose" on correct and slightly wrong results.
+ */
+static bool CheckIdentityTest(void) {
+    Poly p = P(P(C(1), 1, C(-1), 3), 1, C(2), 2, C(3), 3, P(C(4), 2), 4, C(5), 5, C(6), 9);
+    Poly q[] = {P(C(1), 0, C(1), 1), P(C(2), 2)};
+    Poly one = C(1);
+
+    Poly product = PolyMul(&p, &q[0]);
+    Poly wrongProduct = PolyAdd(&product, &one);
+    Poly composition = PolyCompose(&p, 2, q);
+    Poly wrongComposition = PolySub(&composition, &q[1]);
+    Poly big = P(C(LONG_MAX), 1, C(3), 2);
+    Poly overflowed = PolyMul(&big, &big);
+
+    bool res = PolyCheckMul(&p, &q[0], &product, 4);
+    res &= PolyCheckMul(&q[0], &p, &product, 1);
+    res &= !PolyCheckMul(&p, &q[0], &wrongProduct, 4);
+    res &= PolyCheckCompose(&p, 2, q, &composition, 4);
+    res &= !PolyCheckCompose(&p, 2, q, &wrongComposition, 4);
+    res &= !PolyCheckCompose(&p, 1, q, &composition, 4);
+    res &= !PolyCheckMul(&big, &big, &overflowed, 4);
+    res &= !PolyCheckMul(&big, &p, &overflowed, 4);
+
+    /* 2^63 x (x + 1) vanishes at every point modulo 2^64, but not over the integers */
+    Poly zero = C(0);
+    Poly vanishing = P(C(LONG_MIN), 1, C(LONG_MIN), 2);
+    res &= !PolyCheckMul(&zero, &one, &vanishing, 50);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q[0]);
+    PolyDestroy(&q[1]);
+    PolyDestroy(&product);
+    PolyDestroy(&wrongProduct);
+    PolyDestroy(&composition);
+    PolyDestroy(&wrongComposition);
+    PolyDestroy(&big);
+    PolyDestroy(&overflowed);
+    PolyDestroy(&vanishing);
+
+    return res;
+}
+
+/**
+ * Tests "PolySumScaled" against repeated additions.
+ */
+static bool SumScaledTest(void) {
+    Poly p = P(P(C(1), 1, C(-1), 3), 1, C(2), 2, C(3), 3);
+    Poly q = P(C(1), 0, P(C(1), 1), 2);
+    Poly c = C(5);
+    const Poly* polys[] = {&p, &q, &c, &p};
+    poly_coeff_t scales[] = {2, -3, 1, -2};
+
+    Poly sum = PolySumScaled(4, scales, polys);
+    Poly expected = P(C(2), 0, P(C(-3), 1), 2);
+    bool res = PolyIsEq(&sum, &expected);
+
+    /* Exponents as far apart as possible */
+    Poly far = P(C(1), 0, C(1), INT_MAX);
+    const Poly* farPolys[] = {&far, &q, &far};
+    poly_coeff_t farScales[] = {1, 1, 2};
+
+    Poly farSum = PolySumScaled(3, farScales, farPolys);
+    Poly farExpected = P(C(4), 0, P(C(1), 1), 2, C(3), INT_MAX);
+    res &= PolyIsEq(&farSum, &farExpected);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&sum);
+    PolyDestroy(&expected);
+    PolyDestroy(&far);
+    PolyDestroy(&farSum);
+    PolyDestroy(&farExpected);
+
+    return res;
+}
+
+/**
+ * Tests if lazy expressions with shared subexpressions materialize
+ * to the values of eager operations.
+ */
+static bool LazyExprTest(void) {
+    Poly a = P(P(C(1), 1, C(-1), 3), 1, C(2), 2);
+    Poly b = P(C(1), 0, P(C(1), 1), 2);
+    Poly c = P(C(3), 1);
+    Poly d = C(-4);
+
+    /* ((a + b) * c - d) * (a + b) * -4 + (a + b) */
+    PolyExpr* sum = ExprAdd(ExprFromPoly(PolyClone(&a)), ExprFromPoly(PolyClone(&b)));
+    PolyExpr* product = ExprMul(ExprShare(sum), ExprFromPoly(PolyClone(&c)));
+    PolyExpr* difference = ExprSub(product, ExprFromPoly(PolyClone(&d)));
+    PolyExpr* scaled = ExprMul(ExprMul(difference, ExprShare(sum)), ExprFromPoly(PolyClone(&d)));
+    PolyExpr* lazy = ExprAdd(ExprNeg(ExprNeg(scaled)), sum);
+
+    Poly eagerSum = PolyAdd(&a, &b);
+    Poly eagerProduct = PolyMul(&eagerSum, &c);
+    Poly eagerDifference = PolySub(&eagerProduct, &d);
+    Poly eagerLong = PolyMul(&eagerDifference, &eagerSum);
+    Poly eagerScaled = PolyMul(&eagerLong, &d);
+    Poly expected = PolyAdd(&eagerScaled, &eagerSum);
+
+    Poly value = ExprTake(lazy);
+    bool res = PolyIsEq(&value, &expected);
+
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&c);
+    PolyDestroy(&value);
+    PolyDestroy(&eagerSum);
+    PolyDestroy(&eagerProduct);
+    PolyDestroy(&eagerDifference);
+    PolyDestroy(&eagerLong);
+    PolyDestroy(&eagerScaled);
+    PolyDestroy(&expected);
+
+    return res;
+}
+
+/**
+ * Tests linear combinations of polynomials, including cancellation
+ * of terms and constant operands.
+ */
+static bool LinCombTest(void) {
+    Poly p = P(C(1), 0, P(C(2), 1), 1);
+    Poly q = P(C(1), 0, P(C(1), 1), 1, C(3), 2);
+    Poly c = C(2);
+
+    Poly combination = PolyLinComb(2, &p, -4, &q);
+    Poly expected = P(C(-2), 0, C(-12), 2);
+    bool res = PolyIsEq(&combination, &expected);
+    PolyDestroy(&combination);
+    PolyDestroy(&expected);
+
+    combination = PolyLinComb(3, &c, 1, &p);
+    expected = P(C(7), 0, P(C(2), 1), 1);
+    res &= PolyIsEq(&combination, &expected);
+    PolyDestroy(&combination);
+    PolyDestroy(&expected);
+
+    combination = PolySub(&p, &p);
+    res &= PolyIsZero(&combination);
+    PolyDestroy(&combination);
+
+    combination = PolyLinComb(0, &q, 5, &c);
+    res &= PolyIsCoeff(&combination) && combination.coeff == 10;
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+
+    return res;
+}
+
+/**
+ * Tests if scaling and negation in place give the same results
+ * as the copying operations, also when coefficients vanish.
+ */
+static bool ScaleInPlaceTest(void) {
+    Poly p = P(P(C(2), 1, C(4), 2), 1, C(4), 2, P(C(1), 0, C(3), 1), 3);
+    const poly_coeff_t scales[] = {-1, 3, 1L << 62, 0};
+    bool res = true;
+
+    for (size_t i = 0; i < sizeof(scales) / sizeof(scales[0]); i++) {
+        Poly scaled = PolyClone(&p);
+        Poly expected = PolyLinComb(scales[i], &p, 0, &p);
+
+        PolyScaleInPlace(&scaled, scales[i]);
+        res &= PolyIsEq(&scaled, &expected);
+
+        PolyDestroy(&scaled);
+        PolyDestroy(&expected);
+    }
+
+    Poly negated = PolyClone(&p);
+    Poly expected = PolyNeg(&p);
+    PolyNegInPlace(&negated);
+    res &= PolyIsEq(&negated, &expected);
+
+    PolyDestroy(&p);
+    PolyDestroy(&negated);
+    PolyDestroy(&expected);
+
+    return res;
+}
+
+/**
+ * Tests if adding in place gives the same results as PolyLinComb,
+ * also when monomials cancel out or the result becomes constant.
+ */
+static bool AddScaledInPlaceTest(void) {
+    Poly polys[] = {
+        P(C(1), 0, P(C(2), 1), 1, C(3), 5),
+        P(C(-1), 0, P(C(-1), 1), 1, C(3), 5),
+        P(P(C(1), 2), 3, C(7), 9),
+        C(4),
+        P(C(-3), 5),
+        P(C(1), 1, C(2), 3, C(4), 6, C(5), 8, C(9), 10),
+        P(C(-2), 3, C(1), 4, C(-5), 8, C(1), 11),
+        P(C(6), 2, C(-9), 10)
+    };
+    const size_t count = sizeof(polys) / sizeof(polys[0]);
+    const poly_coeff_t scales[] = {1, -1, 2};
+    bool res = true;
+
+    for (size_t pID = 0; pID < count; pID++) {
+        for (size_t qID = 0; qID < count; qID++) {
+            for (size_t scaleID = 0; scaleID < sizeof(scales) / sizeof(scales[0]); scaleID++) {
+                Poly sum = PolyClone(&polys[pID]);
+                Poly expected = PolyLinComb(1, &polys[pID], scales[scaleID], &polys[qID]);
+
+                PolyAddScaledInPlace(&sum, scales[scaleID], &polys[qID]);
+                res &= PolyIsEq(&sum, &expected);
+
+                PolyDestroy(&sum);
+                PolyDestroy(&expected);
+            }
+        }
+    }
+
+    for (size_t pID = 0; pID < count; pID++)
+        PolyDestroy(&polys[pID]);
+
+    return res;
+}
+
+static bool SerializeTest(void) {
+    Poly polys[] = {
+        C(0),
+        C(LONG_MIN),
+        C(LONG_MAX),
+        P(C(1), 0, P(C(-2), 1), 1, C(3), INT_MAX),
+        P(P(C(LONG_MIN), 3, P(C(1), 200), 4), 0, C(-64), 65)
+    };
+    const size_t count = sizeof(polys) / sizeof(polys[0]);
+    bool res = true;
+
+    for (size_t pID = 0; pID < count; pID++) {
+        size_t size = PolySerializedSize(&polys[pID]);
+        uint8_t* bytes = malloc(size);
+        CHECK_PTR(bytes);
+        PolySerialize(&polys[pID], bytes);
+
+        Poly read;
+        size_t consumed = 0;
+        res &= PolyDeserialize(bytes, size, &read, &consumed);
+        res &= (consumed == size && PolyIsEq(&read, &polys[pID]));
+        PolyDestroy(&read);
+
+        /* Every proper prefix is incomplete */
+        for (size_t prefix = 0; prefix < size; prefix++)
+            res &= !PolyDeserialize(bytes, prefix, &read, NULL);
+
+        free(bytes);
+    }
+
+    /* Zero coefficients and a constant monomial of exponent zero are not normal */
+    const uint8_t zeroCoeff[] = {1, 3, 1, 0, 0};
+    const uint8_t freeTerm[] = {1, 3, 0, 0, 2};
+    const uint8_t sameExps[] = {2, 6, 0, 0, 2, 0, 0, 2};
+    Poly read;
+    res &= !PolyDeserialize(zeroCoeff, sizeof(zeroCoeff), &read, NULL);
+    res &= !PolyDeserialize(freeTerm, sizeof(freeTerm), &read, NULL);
+    res &= !PolyDeserialize(sameExps, sizeof(sameExps), &read, NULL);
+
+    for (size_t pID = 0; pID < count; pID++)
+        PolyDestroy(&polys[pID]);
+
+    return res;
+}
+
+static bool SerializedExprTest(void) {
+    Poly p = P(P(C(2), 1), 0, C(-5), 3);
+    Poly q = P(C(1), 3, C(7), 4);
+    size_t size = PolySerializedSize(&p);
+    uint8_t* bytes = malloc(size);
+    CHECK_PTR(bytes);
+    PolySerialize(&p, bytes);
+
+    /* Checking agrees with reading for every damaged byte */
+    bool res = PolySerialCheck(bytes, size) && !PolySerialCheck(bytes, size - 1);
+
+    for (size_t byteID = 0; byteID < size; byteID++) {
+        for (unsigned flip = 1; flip < 256; flip <<= 1) {
+            bytes[byteID] ^= (uint8_t) flip;
+
+            Poly read;
+            size_t consumed = 0;
+            bool readable = PolyDeserialize(bytes, size, &read, &consumed);
+            if (readable)
+                PolyDestroy(&read);
+
+            res &= (PolySerialCheck(bytes, size) == (readable && consumed == size));
+            bytes[byteID] ^= (uint8_t) flip;
+        }
+    }
+
+    /* The representation is read once, although the expression is shared */
+    PolyExpr* serial = ExprFromSerialized(bytes, size);
+    PolyExpr* sum = ExprAdd(ExprShare(serial), ExprFromPoly(PolyClone(&q)));
+    PolyExpr* product = ExprMul(serial, sum);
+
+    Poly expectedSum = PolyAdd(&p, &q);
+    Poly expected = PolyMul(&p, &expectedSum);
+    Poly value = ExprTake(product);
+    res &= PolyIsEq(&value, &expected);
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&expectedSum);
+    PolyDestroy(&expected);
+    PolyDestroy(&value);
+    free(bytes);
+
+    return res;
+}
+
+static bool TermsWidenTest(void) {
+    PolyTerms terms;
+    TermsInitialize(&terms, 1);
+
+    const poly_exp_t short1[] = {2}, short2[] = {0};
+    const poly_exp_t long1[] = {2, 0, 1}, long2[] = {0, 3, 0};
+
+    TermsAppend(&terms, 5, short1);
+    TermsAppend(&terms, -1, short2);
+    TermsWiden(&terms, 3);
+    TermsWiden(&terms, 2);
+
+    bool res = (terms.vars == 3);
+    res &= (terms.exps[0] == 2 && terms.exps[1] == 0 && terms.exps[2] == 0);
+    res &= (terms.exps[3] == 0 && terms.exps[4] == 0 && terms.exps[5] == 0);
+
+    TermsAppend(&terms, 1, long1);
+    TermsAppend(&terms, 4, long2);
+
+    /* 5 x_0^2 - 1 + x_0^2 x_2 + 4 x_1^3 */
+    Poly built = PolyFromTerms(&terms);
+    Poly expected = P(P(C(-1), 0, C(4), 3), 0,
+                      P(P(C(5), 0, C(1), 1), 0), 2);
+    res &= PolyIsEq(&built, &expected);
+
+    PolyDestroy(&built);
+    PolyDestroy(&expected);
+    TermsDestroy(&terms);
+
+    /* A list without variables gets exponent vectors too */
+    TermsInitialize(&terms, 0);
+    TermsAppend(&terms, 7, NULL);
+    TermsWiden(&terms, 2);
+    res &= (terms.vars == 2 && terms.exps[0] == 0 && terms.exps[1] == 0);
+    TermsDestroy(&terms);
+
+    return res;
+}
+
 /** Test groups **/
 
 static bool SimpleNegGroup(void) {
@@ -1263,7 +1990,25 @@ static const test_list_t test_list[] = {
         TEST(MemoryGroup),
         TEST(ComposeTest),
         TEST(PolyOwnTest),
-        TEST(PolyCloneTest)
+        TEST(PolyCloneTest),
+        TEST(PermuteTest),
+        TEST(DeflatedMulTest),
+        TEST(ComposeShapeTest),
+        TEST(ParallelComposeTest),
+        TEST(EvalPointTest),
+        TEST(EvalPointsTest),
+        TEST(CompiledEvalTest),
+        TEST(AtSpecialValuesTest),
+        TEST(EvalDoubleTest),
+        TEST(CheckIdentityTest),
+        TEST(SumScaledTest),
+        TEST(LazyExprTest),
+        TEST(LinCombTest),
+        TEST(ScaleInPlaceTest),
+        TEST(AddScaledInPlaceTest),
+        TEST(SerializeTest),
+        TEST(SerializedExprTest),
+        TEST(TermsWidenTest)
 };
 
 int main() {